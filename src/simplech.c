@@ -56,6 +56,12 @@
   black player, so you increase the value v if you think the
   position is good for black.
 
+  the weights of the evaluation terms are in opt.weights, by
+  default defaultweights. setoption(&opt, "weights", file) reads
+  them from a file of "name value" lines. "simplech tune" fits
+  them to the results of games, e.g. of those that
+  "simplech match -record file" plays.
+
   if you want to program a different interface, you call the
   function "checkers":
 
@@ -66,8 +72,9 @@
   OCCUPIED}. OCCUPIED are those squares which do not appear in the
   above board representation, i.e. 0,1,2,3,9,18,27,36,41-45.
   color is the color to move, either BLACK or WHITE.
-  maxtime is the about half the average time it will take to
-  calculate a move.
+  maxtime is the wall clock time the search may take at most;
+  the search is cut off there and plays the best move of the
+  last iteration it completed.
 
   after checkers completes, you will have the new board position in
   b[46] and some information on the search in str.
@@ -75,6 +82,88 @@
   initcheckers(int b[46]) initializes board b to the starting
   position of checkers.
 
+  setfen(b, "W:W21,22,K30:B1,2,3") sets up b from a fen string and
+  returns the side to move, fenstring(b, color, str) writes one.
+  packposition(b, color, record) packs a position into 16 bytes,
+  unpackposition(record, b) unpacks it.
+
+  checkers keeps one engine for the whole process and is not
+  reentrant. to run several searches at the same time, e.g. one
+  game per thread, give each search its own engine:
+
+  struct options opt;
+  struct engine *e;
+
+  defaultoptions(&opt);
+  setoption(&opt, "threads", "4");
+  e = newengine(&opt);
+  e->out = stdout;
+  searchmove(e, b, color, maxtime, str);
+  freeengine(e);
+
+  e->out receives the search output, NULL silences it. engines
+  share no mutable state.
+
+  setoption(&opt, "store", file) gives the engines an analysis
+  store: a file of search results by position, mapped and shared
+  between engines and processes. a search looks there first and
+  leaves its result there. results are found by position alone, so
+  one store should only serve engines with the same weights and
+  search options; repetitions of the game are not taken into
+  account either.
+
+  savehashtable(e, file) and loadhashtable(e, file) keep the
+  hashtable of e across runs; with setoption(&opt, "hashfile", file)
+  newengine loads it at once.
+
+  with setoption(&opt, "hashshm", "/name") the hashtable lives in
+  posix shared memory, one table for all processes that name it.
+
+  startsearch(e, b, color, &lim, progress, arg) searches a copy of
+  b on a thread of its own and returns a handle at once. the
+  callback progress(info, arg) gets the depth, score, nodes and
+  principal variation of every iteration, and the result with
+  info->done set. cancelsearch(s) stops the search, searchdone(s)
+  polls it, and waitsearch(s, &result) waits for it and frees s.
+  newsearch and runsearch(s) search on a thread of the caller's
+  instead, e.g. of a pool.
+
+  "simplech server socket" serves games on a unix domain socket,
+  each connection a session of the engine protocol with an engine
+  of its own, their searches run by a fixed pool of threads.
+
+  compiled with TRACE defined below, setoption(&opt, "trace", file)
+  appends an event for every node searched to file. "make simtrace"
+  builds the tool that reports on it: nodes by ply and depth, move
+  ordering and the most expensive subtrees.
+
+  to have repeated positions scored as draws, tell the engine
+  the game: gamestart(e, b, color) when it starts, and
+  gamemove(e, move) after each move of the opponent. searchmove
+  records its own moves. gamemove returns how often the new
+  position was on the board before.
+
+  after a search, e->stats holds its counters summed over all
+  threads, e->iteration[0 .. e->iterations-1] the nodes and time
+  of each completed iteration. statsjson(fp, e) writes both as
+  one json object.
+
+  pdnread(file, check, callback, arg) maps a pdn file and calls
+  callback(g, arg) for each game, with its tags, start position
+  and the moves checked against the move generator in g; with
+  check 0 a quiet move is not tested for a capture it had to make.
+  pdnopen, pdnwrite and pdnclose write games back out.
+
+  "make libsimplech.so" builds the engine as a shared library
+  with the checkerboard engine interface, declared in simplech.h:
+
+      getmove(int board[8][8], int color, double maxtime,
+              char str[1024], int *playnow, int info, int moreinfo,
+              struct CBmove *move);
+
+  getmove is thread safe: each calling thread gets its own engine,
+  which it keeps from move to move.
+
   have fun!
 
   questions, comments, suggestions to:
@@ -88,6 +177,11 @@
 #undef MAC
 #define UNIX
 
+/*----------> trace the search: alphabeta writes an event for every node
+  ----------> to the file of the trace option, see simtrace.c. without
+  ----------> TRACE, the search does not know about it. */
+#undef TRACE
+
 #ifdef WIN95
 #include <windows.h>
 unsigned int _stklen = 50000;
@@ -102,15 +196,25 @@ unsigned int _stklen = 40000;
 
 /*----------> includes */
 #include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <errno.h>
 #include <time.h>
 #include <ctype.h>
-
-#ifdef UNIX
-#define TICKS CLOCKS_PER_SEC
-#else
-#define TICKS CLK_TCK
-#endif
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/signalfd.h>
+#include <poll.h>
+#include <signal.h>
+#include "simplech.h"
 
 /*----------> definitions */
 #define OCCUPIED 0
@@ -121,13 +225,89 @@ unsigned int _stklen = 40000;
 #define FREE 16
 #define CHANGECOLOR 3
 #define MAXDEPTH 99
-#define MAXMOVES 20
+#define MAXMOVES 64		/* 12 kings have at most 48 moves */
 #define MAXTIME 0.05
+#define MAXPLY 128
+#define MAXTHREADS 64
+#define BENCHDEPTH 14		/* default depth of the bench signature */
+#define MICROTIME 0.02		/* seconds per microbenchmark repetition */
+#define MICROREPS 10
+#define ADJWIN 400		/* match: a game is won when both engines */
+#define ADJPLIES 8		/* agree on this score for this many plies */
+#define DRAWPLIES 80		/* drawn after this many king moves, */
+#define MAXPLIES 400		/* or this many plies */
+#define POLLNODES 1024		/* nodes between two looks at the clock */
+#define MOVEOVERHEAD 0.02	/* seconds lost per move outside the search */
+#define CBMOVES 20		/* getmove: moves of an average maxtime on the clock */
+#define SCOREDROP 20		/* a drop this large buys more time */
+#define CLEARMARGIN 60		/* a move this much better ends the search */
+#define LMRMOVES 3		/* moves searched before reductions start */
+#define PCREDUCE 4		/* probcut: depth of the shallow search is */
+#define PCMINDEPTH 6		/* depth - PCREDUCE, from PCMINDEPTH on */
+#define PCSLOPE 1.01		/* probcut model defaults, see probcutfit */
+#define PCOFFSET 0.0
+#define PCSIGMA 21.0
+#define CUTINDEX 8		/* cutoffs are counted by move index up to this */
+#define GAMERING 256		/* game positions kept for repetitions */
+#define HASHBITS 20		/* 2^20 entries of 16 bytes */
+#define STOREBITS 20		/* a new analysis store has 2^20 slots */
+#define STOREPROBE 8		/* slots an entry may be placed in */
+#define STOREVERSION 1
+#define HASHVERSION 1		/* of the hashtable files of savehashtable */
+#define HASHCHUNK (1 << 16)	/* entries read or written at a time */
+#define MAXPV 32		/* moves of a principal variation */
+#define SESSIONS 64		/* server: connections at most, by default */
+#define LATENCIES 1024		/* searches per session kept for percentiles */
+#define SESSIONOUTPUT (1 << 20)	/* bytes of answers a session may leave unread */
+#define FENLENGTH 128		/* enough for any fen string */
+#define RECORDSIZE 16		/* bytes of a packed position */
+#define PDNTAGS 16		/* tags of a game kept by pdnread */
+#define PDNPLIES 1024		/* and moves */
+#define PDNBUFFER (1 << 20)	/* bytes buffered by the pdn writer */
+#define TRACEEVENTS ((1 << 16) - 1)	/* per thread between two writes */
+#define TRACENONE 255		/* no move of the node was best */
+#define TRACEHIT 1		/* trace flags: a hashtable entry was found, */
+#define TRACEHASHCUT 2		/* and was deep enough */
+#define TRACELEAF 4		/* the node was evaluated */
+#define TRACEREPEAT 8		/* a repetition */
+#define TRACEPROBCUT 16		/* cut by probcut */
+#define TRACECUT 32		/* a move failed high */
+#define TRACESTOP 64		/* the search was stopped in the node */
+#define TRACEJUMP 128		/* the move to the node was a capture */
+#ifdef TRACE
+#define TRACEFLAG(t, ply, flag) ((t)->traceflags[ply] |= (flag))
+#define TRACEBEST(t, ply, i) ((t)->tracebest[ply] = (i))
+#else
+#define TRACEFLAG(t, ply, flag) ((void) 0)
+#define TRACEBEST(t, ply, i) ((void) 0)
+#endif
+#define TUNEEPOCHS 1000	/* tune: gradient descent steps, */
+#define TUNERATE 0.1		/* their size */
+#define EXACT 3
+#define ALPHABETA 0		/* search drivers */
+#define MTDF 1
+#define LOWER 1
+#define UPPER 2
+#define EVTURN 0		/* the evaluation weights, see evaluation */
+#define EVBRV 1
+#define EVKCV 2
+#define EVMCV 3
+#define EVMEV 4
+#define EVKEV 5
+#define EVCRAMP 6
+#define EVOPENING 7
+#define EVMIDGAME 8
+#define EVENDGAME 9
+#define EVDOUBLECORNER 10
+#define EVSAFEEDGE 11
+#define EVBACKRANK 12		/* 16 entries, by the men on the back rank */
+#define NWEIGHTS 28
+#define PDNUNKNOWN 2		/* result of an unfinished game */
 
 /*----------> compile options  */
+/* SIMPLECHLIB is defined by the libsimplech.so build and leaves out main */
 #undef MUTE
 #undef VERBOSE
-#undef STATISTICS
 #undef SHOWLONGMOVES
 #ifdef SHOWLONGMOVES
 #define LONGMOVE 5
@@ -140,21 +320,518 @@ struct move2
     int m[8];
   };
 
+struct hashentry
+  {
+    uint64_t lock;		/* key ^ data, see hashstore */
+    uint64_t data;
+  };
+
+struct hashheader
+  {
+    char magic[8];		/* "simphash" */
+    uint32_t version;		/* HASHVERSION */
+    uint32_t hashbits;		/* the table has 2^hashbits entries */
+    uint32_t hashage;
+    uint32_t entrysize;		/* sizeof (struct hashentry) */
+    uint64_t zobrist;		/* a check of the zobrist keys */
+    uint64_t reserved[4];	/* 0, the header is 64 bytes */
+  };
+
+struct storeheader
+  {
+    char magic[8];		/* "simpstor" */
+    uint32_t version;		/* STOREVERSION */
+    uint32_t slotbits;		/* the store has 2^slotbits slots */
+    uint64_t reserved[6];	/* 0, the header is 64 bytes */
+  };
+
+struct storeentry
+  {
+    uint64_t lock;		/* key ^ data ^ nodes, see storeupdate */
+    uint64_t data;		/* value, depth and move as in the hashtable */
+    uint64_t nodes;
+  };
+
+struct store
+  {
+    struct storeheader *header;	/* mapped, shared with other processes */
+    struct storeentry *entry;
+    uint64_t mask;
+    size_t size;		/* of the mapping */
+  };
+
+struct options
+  {
+    int threads;		/* search threads, the main thread included */
+    int hashbits;		/* the hashtable has 2^hashbits entries */
+    int driver;			/* ALPHABETA or MTDF */
+    int lmr;			/* late move reductions on/off */
+    int futility;		/* futility pruning on/off */
+    int probcut;		/* probcut on/off */
+    double pcslope, pcoffset;	/* probcut: deep = slope * shallow + offset */
+    double pcsigma;		/* with this standard deviation, */
+    double pcthreshold;		/* cut at this many sigmas from the window */
+    int stats;			/* report the search statistics */
+    int ponder;			/* think on the opponent's time */
+    int weights[NWEIGHTS];	/* of the evaluation */
+    char *store;		/* file of the analysis store, or NULL */
+    char *hashfile;		/* hashtable loaded by newengine, or NULL */
+    char *hashshm;		/* shared memory of the hashtable, or NULL */
+#ifdef TRACE
+    char *trace;		/* file the search is traced to, or NULL */
+#endif
+  };
+
+struct searchstats
+  {
+    long nodes;
+    long qnodes;		/* nodes at the horizon, evaluated or extended */
+    long evaluations;
+    long movelists, capturelists;	/* generated */
+    long hashprobes, hashhits, hashcuts;	/* entry found, and deep enough */
+    long cutoffs[CUTINDEX];	/* by index of the move in the ordered list,
+				   the last counts all later moves */
+  };
+
+struct iteration
+  {
+    int depth;
+    int value;
+    long nodes;			/* main thread nodes in this iteration */
+    double time;		/* seconds */
+  };
+
+struct engine
+  {
+    struct options opt;
+    struct hashentry *hashtable;	/* shared by the threads of a search */
+    int hashshared;		/* the hashtable is in shared memory */
+    struct store *store;	/* consulted before a search, or NULL */
+    uint64_t hashmask;
+    int hashage;
+    volatile int stop;		/* tells all search threads to unwind */
+    double deadline;		/* walltime at which the search stops, or 0 */
+    long nodelimit;		/* main thread nodes at which it stops, or 0 */
+    double allotted;		/* seconds the last search was allowed */
+    double overshoot;		/* seconds it ran over that */
+    FILE *out;			/* search output, NULL for none */
+    uint64_t game[GAMERING];	/* hash keys of the game so far, a ring */
+    long gameplies;		/* positions recorded, 0 without a game */
+    int gamereversible;		/* king moves since the last man move or capture */
+    struct searchstats stats;	/* of the last search, all threads */
+    struct iteration iteration[MAXDEPTH + 1];	/* its completed iterations */
+    int iterations;
+    double searchtime;
+    volatile int *playnow;	/* the search stops when *playnow is set */
+    volatile int pondering;	/* no limits apply until ponderhit */
+    volatile double ponderhit;	/* walltime at which pondering ended */
+    void (*iterated) (struct engine *e, struct move2 best, void *arg);
+    void *iteratedarg;		/* iterated is called after each iteration */
+  };
+
+struct limits
+  {
+    double time;		/* seconds, 0 for no limit */
+    int depth;			/* iterations, 0 for no limit */
+    long nodes;			/* nodes of the main thread, 0 for no limit */
+    double remaining;		/* game clock: time left, 0 if none */
+    double increment;		/* added to the clock after each move */
+    int movestogo;		/* until the next time control, 0 for all */
+  };
+
+struct searchinfo		/* the progress and result of startsearch */
+  {
+    int depth;
+    int value;
+    long nodes;			/* of the main thread so far, at the end of all */
+    double time;		/* seconds since the start */
+    struct move2 pv[MAXPV];	/* the moves expected, the best move first */
+    int pvlength;		/* 0 if there is no move */
+    int done;			/* the search is over, this is its result */
+  };
+
+struct search			/* the handle of a search started by startsearch */
+  {
+    struct engine *e;
+    int b[46];			/* a copy of the position */
+    int color;
+    struct limits lim;
+    void (*progress) (struct searchinfo *info, void *arg);
+    void *arg;
+    volatile int cancel;	/* the engine's playnow during the search */
+    volatile int *playnow;	/* and the one it had before */
+    volatile int done;
+    double start;
+    struct searchinfo result;
+    int threaded;		/* runs on thread, started by startsearch */
+    pthread_t thread;
+  };
+
+struct batchresult
+  {
+    int done;
+    int status;			/* 0 searched, -1 bad position, 1 no move, */
+				/* 2 no engine, out of memory */
+    char move[80];
+    int eval, depth;
+    long nodes;
+    double time;
+    char *stats;		/* json, with the stats option */
+  };
+
+struct batch
+  {
+    char **position;
+    int n;
+    int next;			/* next position to hand out */
+    struct batchresult *result;
+    struct options *opt;
+    struct limits *lim;
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+  };
+
+struct protocol
+  {
+    struct options opt;
+    struct engine *e;
+    int b[46];			/* the position of the next go */
+    int color;
+    struct search *search;	/* of the go command, or NULL */
+    int served;			/* go only prepares it, a server worker runs it */
+    FILE *fp;			/* the answers go here, or to output if served */
+    char *output;		/* answers to a server session not yet written */
+    size_t outputlength, outputsize;
+    int broken;			/* they cannot be written, and are dropped */
+    int wake;			/* told when output is added */
+    pthread_mutex_t out;	/* one line of them at a time */
+  };
+
+struct request			/* a command line waiting in a session */
+  {
+    char *line;
+    double arrival;		/* walltime it was read */
+    int search;			/* it is a go, counted in server searches */
+    struct request *next;
+  };
+
+struct session			/* a connection of the server */
+  {
+    struct protocol p;		/* its engine, position and answers */
+    int fd;
+    int id;
+    char input[1024];		/* a line read in part */
+    int inputlength;
+    int discard;		/* the rest of a line too long is dropped */
+    struct request *head, *tail;	/* commands waiting */
+    int scheduled;		/* in the run queue or with a worker */
+    int closing;		/* quit or end of input, freed when idle */
+    struct search *running;	/* the search of a worker, or NULL */
+    int stopping;		/* it was told to stop */
+    double latency[LATENCIES];	/* of the last searches, go to bestmove */
+    long searches;
+    struct session *next;	/* in the run queue */
+    pthread_mutex_t lock;
+  };
+
+struct server
+  {
+    struct options opt;
+    struct session **session;	/* maxsessions slots, NULL if free */
+    int sessions, maxsessions;
+    int searches;		/* waiting or running */
+    int maxsearches;		/* a go beyond this is refused */
+    long accepted, refused;	/* connections, and connections or gos */
+    struct session *head, *tail;	/* the run queue */
+    int wake[2];		/* a pipe: a session has output */
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+  };
+
+struct match
+  {
+    struct options opt[2];	/* of engine a and engine b */
+    struct limits *lim;		/* per move */
+    int (*board)[46];		/* the openings */
+    int *color;
+    int openings;
+    int games;			/* to play at most */
+    int next;			/* next game to hand out */
+    int played;
+    int wins, draws, losses;	/* of engine a */
+    double elo0, elo1, alpha, beta;	/* the sprt hypotheses and errors */
+    int decided;		/* -1 h0 accepted, 1 h1 accepted */
+    double start;
+    FILE *record;		/* positions and results for tune, or NULL */
+    pthread_mutex_t lock;
+  };
+
+struct pdntag
+  {
+    const char *name, *value;	/* not terminated, into the file */
+    int namelength, valuelength;
+  };
+
+struct pdngame
+  {
+    struct pdntag tag[PDNTAGS];
+    int tags;
+    int b[46];			/* the start position */
+    int color;			/* to move there */
+    struct move2 move[PDNPLIES];	/* the moves from there, checked */
+    int plies;
+    int result;			/* 1 black won, -1 white won, 0 draw, */
+				/* PDNUNKNOWN */
+    const char *error;		/* why the game is invalid, or NULL */
+    long line;			/* of the game in the file */
+    int check;			/* quiet moves are tested for a capture */
+  };
+
+struct pdnwriter
+  {
+    FILE *fp;
+    char *buffer;
+  };
+
+struct pdnsummary
+  {
+    char *filename;
+    long games, invalid, plies;
+    struct pdnwriter *out;	/* the valid games are copied here, or NULL */
+  };
+
+struct tuneposition
+  {
+    int fixed;			/* the evaluation without the tuned weights */
+    short feature[NWEIGHTS];	/* plus feature[i] times each weight i */
+    float result;		/* for black: 1 win, 0.5 draw, 0 loss */
+  };
+
+struct tunejob
+  {
+    struct tuneposition *pos;
+    long n;
+    double *weights;
+    double k;			/* of the sigmoid, result = 1/(1+exp(-k*eval)) */
+    double error;		/* sum of the squared errors */
+    double gradient[NWEIGHTS];	/* and its gradient, */
+    int wantgradient;		/* if wanted */
+    char (*lines)[40];		/* tuneextract: the positions as text, */
+    int *base;			/* evaluated with these weights */
+    long bad;			/* lines it could not read */
+  };
+
+struct ponder
+  {
+    struct engine *e;
+    int b[46];			/* the position pondered on */
+    int color;
+    volatile int stop;
+    int running;
+    FILE *out;			/* of e, which is quiet while pondering */
+    pthread_t thread;
+  };
+
+struct cbsession
+  {
+    struct engine *e;		/* of one thread calling getmove */
+    int b[46];			/* the board after its last move */
+    int color;			/* to move on b */
+  };
+
+#ifdef TRACE
+struct traceevent		/* a node of the search, see simtrace.c */
+  {
+    uint32_t nodes;		/* in the subtree of the node, itself included */
+    int16_t alpha, beta;	/* the window the node was searched with */
+    int16_t value;		/* its result */
+    uint16_t move;		/* movecode of the move to the node, 0 at the root */
+    uint8_t ply, depth;
+    uint8_t best;		/* index of the move which cut or was best, */
+				/* TRACENONE */
+    uint8_t flags;		/* TRACEHIT ... */
+  };
+
+struct traceblock		/* heads the events of one thread in the file */
+  {
+    char magic[4];		/* "simt" */
+    uint32_t process;
+    uint32_t search;		/* counts the searches of the process */
+    uint16_t thread;		/* 0 is the main thread */
+    uint16_t events;		/* which follow */
+  };
+#endif
+
+struct searchthread
+  {
+    struct engine *e;
+    int id;			/* 0 is the main thread */
+    int b[46];
+    int color;
+    uint64_t path[GAMERING + MAXPLY];	/* the reversible end of the game, */
+    uint64_t *key;		/* then the keys of the search path from here */
+    int reversible[MAXPLY];	/* keys before key[ply] a repetition may use */
+    int killer[MAXPLY][2];
+    int history[46][46];
+    struct searchstats stats;	/* this thread's share */
+    pthread_t thread;
+#ifdef TRACE
+    int tracefd;		/* the trace file, opened for appending */
+    struct traceevent *trace;	/* events, after room for a traceblock, or NULL */
+    int traced;			/* events in trace */
+    uint32_t search;
+    int tracemove[MAXPLY];	/* movecode of the move to each ply, */
+    int traceflags[MAXPLY];	/* what happened in the node there, */
+    int tracebest[MAXPLY];	/* and the index of its best move */
+#endif
+  };
+
 /*----------> function prototypes  */
 /*----------> part I: interface */
 void printboard (int human, int b[46], int color);
 void initcheckers (int b[46]);
-void timerroutine (int human, int b[46]);
+int setposition (int b[46], char *str);
+void positionstring (int b[46], int color, char str[36]);
+int setfen (int b[46], char *str);
+void fenstring (int b[46], int color, char str[FENLENGTH]);
+void packposition (int b[46], int color, unsigned char record[RECORDSIZE]);
+int unpackposition (unsigned char record[RECORDSIZE], int b[46]);
+int pack (char *filename, char *out);
+int unpack (char *filename);
+int compactstore (char *filename, char *out);
+int squareindex (int square);
+int squarenumber (int i);
+long pdnread (char *filename, int check, int (*callback) (struct pdngame *g, void *arg), void *arg);
+const char *pdnmovetext (struct pdngame *g, const char *p, const char *end, long *line);
+int pdnmove (struct pdngame *g, int b[46], int color, int squares[], int n);
+struct pdnwriter *pdnopen (char *filename);
+void pdnwrite (struct pdnwriter *w, struct pdngame *g);
+int pdnclose (struct pdnwriter *w);
+int pdncommand (char *filename, char *out, int check);
+int pdnsummarize (struct pdngame *g, void *arg);
+void smpbenchmark (struct options *opt, double maxtime);
+void benchmark (struct options *opt, int depth);
+void driverbenchmark (struct options *opt, int depth);
+void selectbenchmark (struct options *opt, int depth);
+void probcutfit (char *filename, struct options *opt, int depth);
+void perftcommand (int depth);
+long perft (int b[46], int color, int depth);
+int batchanalysis (char *filename, struct options *opt, struct limits *lim, int jobs);
+void *batchworker (void *arg);
+void jsonstring (FILE *fp, char *str);
+int match (char *filename, struct options *opt, char *config[2], struct limits *lim, int games, double sprt[4], int jobs, char *record);
+int loadopenings (struct match *m, char *filename);
+int addopening (struct match *m, int *size, int b[46], int color);
+int dropopenings (struct match *m);
+void *matchworker (void *arg);
+int playgame (struct match *m, struct engine *black, struct engine *white, int b[46], int color, int *plies, char **reason, char positions[][36]);
+double sprtllr (struct match *m, double *elo, double *margin);
+int tune (char *filename, struct options *opt, int epochs, int jobs);
+long loadtunepositions (char *filename, struct tuneposition **pos, int weights[NWEIGHTS], int jobs);
+void *tuneextract (void *arg);
+double tuneerror (struct tuneposition *pos, long n, double weights[NWEIGHTS], double k, double gradient[NWEIGHTS], int jobs);
+void *tuneworker (void *arg);
+int protocol (struct options *opt);
+int protocolcommand (struct protocol *p, char *line);
+int protocolposition (struct protocol *p, char *args);
+int playmove (struct engine *e, int b[46], int *color, char *notation);
+void protocolinfo (struct searchinfo *info, void *arg);
+void stopsearch (struct protocol *p, int now);
+void reply (struct protocol *p, char *format, ...);
+int server (char *path, struct options *opt, int jobs, int maxsessions, int maxsearches);
+struct session *opensession (struct server *sv, int fd);
+void closesession (struct session *s);
+void endsession (struct server *sv, struct session *s);
+int sessionwrite (struct session *s);
+void sessioninput (struct server *sv, struct session *s, char *line);
+void schedule (struct server *sv, struct session *s);
+void *serverworker (void *arg);
+void sessioncommand (struct server *sv, struct session *s, struct request *r);
+void droprequests (struct server *sv, struct session *s);
+void sessionlatency (struct session *s, char str[160]);
+int comparedoubles (const void *a, const void *b);
+void startponder (struct ponder *pd, struct engine *e, int b[46], int color);
+void stopponder (struct ponder *pd);
+void *pondersearch (void *arg);
+void usage (void);
+void microbenchmark (int json);
+long microkernel (int kernel, int boards[][46], int colors[], struct move2 moves[][MAXMOVES], int counts[], int n, long rounds, volatile int *sink);
 void movetonotation (struct move2 move, char str[80]);
 char *reduce (char str[80]);	/* pch */
 int partof (char buf[240], char str[80]);	/* pch */
 /*----------> part II: search */
+void defaultoptions (struct options *opt);
+int setoption (struct options *opt, char *name, char *value);
+int optionname (char **option, char *value);
+int samename (char *a, char *b);
+int copyoptions (struct options *to, struct options *from);
+void freeoptions (struct options *opt);
+int loadweights (int w[NWEIGHTS], char *filename);
+void printweights (FILE *fp, int w[NWEIGHTS]);
+struct engine *newengine (struct options *opt);
+void freeengine (struct engine *e);
+void gamestart (struct engine *e, int b[46], int color);
+int gamemove (struct engine *e, struct move2 move);
+int gamerepetitions (struct engine *e);
+int gamehistory (struct engine *e, uint64_t key, uint64_t *path);
+int searchmove (struct engine *e, int b[46], int color, double maxtime, char *str);
+int enginemove (struct engine *e, int b[46], int color, struct limits *lim, char *str);
+int expectedreply (struct engine *e, int b[46], int color, struct move2 *reply);
+int hashpv (struct engine *e, int b[46], int color, struct move2 best, int depth, struct move2 pv[MAXPV]);
+struct search *startsearch (struct engine *e, int b[46], int color, struct limits *lim,
+			    void (*progress) (struct searchinfo *info, void *arg), void *arg);
+void cancelsearch (struct search *s);
+int searchdone (struct search *s);
+int waitsearch (struct search *s, struct searchinfo *result);
+struct search *newsearch (struct engine *e, int b[46], int color, struct limits *lim,
+			  void (*progress) (struct searchinfo *info, void *arg), void *arg);
+void *runsearch (void *arg);
+void searchprogress (struct engine *e, struct move2 best, void *arg);
+void allocatetime (int b[46], struct limits *lim, double *soft, double *hard);
+int clearlybest (struct searchthread *t, int depth, int color, struct move2 best, int eval);
 int checkers (int b[46], int color, double maxtime, char *str);
-int alphabeta (int b[46], int depth, int alpha, int beta, int color);
-int firstalphabeta (int b[46], int depth, int alpha, int beta, int color, struct move2 *best);
+long smpsearch (struct engine *e, int b[46], int color, struct limits *lim, struct move2 *best, int *eval, int *depth);
+void recorditeration (struct engine *e, int depth, int value, long nodes, double time);
+void addstats (struct searchstats *sum, struct searchstats *s);
+void statsjson (FILE *fp, struct engine *e);
+char *statsstring (struct engine *e);
+void *helpersearch (void *arg);
+int alphabeta (struct searchthread *t, int b[46], int depth, int ply, int alpha, int beta, int color);
+int firstalphabeta (struct searchthread *t, int b[46], int depth, int alpha, int beta, int color, struct move2 *best);
+#ifdef TRACE
+int searchnode (struct searchthread *t, int b[46], int depth, int ply, int alpha, int beta, int color);
+int searchroot (struct searchthread *t, int b[46], int depth, int alpha, int beta, int color, struct move2 *best);
+void tracenode (struct searchthread *t, int ply, int depth, int alpha, int beta, int value, long nodes);
+void traceflush (struct searchthread *t);
+#endif
+int mtdf (struct searchthread *t, int b[46], int depth, int guess, int color, struct move2 *best);
+int iterate (struct searchthread *t, int depth, int guess, struct move2 *best);
+void ordermoves (struct searchthread *t, struct move2 movelist[MAXMOVES], int n, int hashmove, int ply);
+void goodmove (struct searchthread *t, struct move2 move, int depth, int ply, int capture);
+int repetition (struct searchthread *t, int ply);
+void pushkey (struct searchthread *t, int ply, struct move2 move);
+void pollstop (struct searchthread *t);
+double walltime (void);
+/*----------> part IIa: hashing */
+void initzobrist (void);
+void clearhashtable (struct engine *e);
+uint64_t hashposition (int b[46], int color);
+uint64_t hashupdate (uint64_t key, struct move2 move);
+int hashprobe (struct engine *e, uint64_t key, int depth, int alpha, int beta, int *value, int *move);
+void hashstore (struct engine *e, uint64_t key, int depth, int value, int bound, int move);
+struct hashentry *sharedhashtable (char *name, int hashbits, uint64_t *mask);
+int savehashtable (struct engine *e, char *filename);
+int loadhashtable (struct engine *e, char *filename);
+struct store *openstore (char *filename, int slotbits);
+void closestore (struct store *s);
+int storeprobe (struct store *s, uint64_t key, int *depth, int *value, int *move, long *nodes);
+int storeupdate (struct store *s, uint64_t key, int depth, int value, int move, long nodes);
+int movecode (struct move2 move);
 void domove (int b[46], struct move2 move);
 void undomove (int b[46], struct move2 move);
-int evaluation (int b[46], int color);
+int evaluation (int b[46], int color, const int w[NWEIGHTS]);
+int material (int b[46]);
 /*----------> part III: move generation */
 int generatemovelist (int b[46], struct move2 movelist[MAXMOVES], int color);
 int generatecapturelist (int b[46], struct move2 movelist[MAXMOVES], int color);
@@ -163,19 +840,68 @@ void blackkingcapture (int b[46], int *n, struct move2 movelist[MAXMOVES], int s
 void whitemancapture (int b[46], int *n, struct move2 movelist[MAXMOVES], int square);
 void whitekingcapture (int b[46], int *n, struct move2 movelist[MAXMOVES], int square);
 int testcapture (int b[46], int color);
+/*----------> part IV: checkerboard interface */
+void cbinit (void);
+void cbfree (void *arg);
+void cbtoboard (int board[8][8], int b[46]);
+void boardtocb (int b[46], int board[8][8]);
+void cbmove (struct move2 move, struct CBmove *cbm);
+int cbcontinue (struct cbsession *s, int b[46], int color);
 
 /*----------> globals  */
-#ifdef STATISTICS
-int alphabetas, generatemovelists, evaluations, generatecapturelists, testcaptures;
+/* all search state lives in struct engine and struct searchthread; the
+ * only globals are constant once initialized */
+uint64_t zobrist[46][17], zobristcolor;
+pthread_once_t zobristonce = PTHREAD_ONCE_INIT;
+/* the cbsession of each thread calling getmove */
+pthread_key_t cbkey;
+pthread_once_t cbonce = PTHREAD_ONCE_INIT;
+#ifdef TRACE
+/* the searches traced so far, numbering them in the trace file */
+uint32_t tracesearches;
 #endif
-int value[17] =
-{0, 0, 0, 0, 0, 1, 256, 0, 0, 16, 4096, 0, 0, 0, 0, 0, 0};
+
+/* the evaluation weights by name, for loadweights, and their defaults */
+const char *weightnames[NWEIGHTS] =
+{
+  "turn", "brv", "kcv", "mcv", "mev", "kev", "cramp", "opening", "midgame",
+  "endgame", "intactdoublecorner", "safeedge",
+  "backrank0", "backrank1", "backrank2", "backrank3", "backrank4", "backrank5",
+  "backrank6", "backrank7", "backrank8", "backrank9", "backrank10",
+  "backrank11", "backrank12", "backrank13", "backrank14", "backrank15"
+};
+const int defaultweights[NWEIGHTS] =
+{
+  2, 3, 5, 1, 1, 5, 5, -2, -1, 2, 3, 15,
+  0, -1, 1, 0, 1, 1, 2, 1, 1, 0, 7, 4, 2, 2, 9, 8
+};
+
+/* a fixed set of positions for benchmarking, one per line in the format
+ * of setposition: squares 1..32 and the side to move */
+char *benchpositions[] =
+{
+  "bbbbbbbbbbbb--------wwwwwwwwwwww b",	/* opening */
+  "bbbbbb-bb-bb--bbw--wwww--wwwwwww b",
+  "bbb-bbbbb-bbw----wwb--w--wwwwwww w",
+  "b-bb--bbbbbbb-b---w-wwwww-www-ww b",
+  "bbb-bb----bbw-b--b-ww----ww-wwww b",	/* midgame */
+  "b-b-----bwbw-------bwbw----w-w-- b",
+  "----bwb---b-wb--w--ww-b----wB--- b",
+  "bbbbbbbb-wbbb-------w-wwwwwwwwww b",	/* captures */
+  "bbbb-b-bbb-wbbw-----w-w-w-wwwwww b",
+  "bb---b-b-b-bw--bwbwb--ww--w--w-w w",
+  "b-b------w-wb-Ww--B-w--b---w--B- b",	/* endgame */
+  "------w---bbw-------w--------B-- w",
+  "-W-------WW----------B---B-----B w",
+  "WW-----------w--------------B--B b"
+};
 
 
 /*-------------- PART I: INTERFACE ------------------------------------------*/
 
+#ifndef SIMPLECHLIB
 int
-main ()
+main (int argc, char *argv[])
 /*----------> purpose: provide a simple interface to checkers.
   ----------> version: 1.0
   ----------> date: 24th october 97 */
@@ -194,6 +920,203 @@ main ()
   struct move2 movelist[MAXMOVES];
   int i;
   double maxtime;
+  char *command = NULL, *file = NULL;
+  int jobs = 0, json = 0, games = 0, epochs = TUNEEPOCHS;
+  int sessions = 0, queue = 0, check = 1;
+  char *config[2] = {"", ""}, *record = NULL, *out = NULL;
+  double sprt[4] = {0, 5, 0.05, 0.05};
+  struct limits lim = {0};
+  struct limits game = {0};
+  double start;
+  struct options opt;
+  struct engine *e;
+  struct ponder pd = {NULL};
+
+/*----------> command line, see usage */
+  defaultoptions (&opt);
+  for (i = 1; i < argc; i++)
+    {
+      if (!strcmp (argv[i], "smpbench") || !strcmp (argv[i], "batch")
+	  || !strcmp (argv[i], "driverbench") || !strcmp (argv[i], "selectbench")
+	  || !strcmp (argv[i], "probcutfit") || !strcmp (argv[i], "perft")
+	  || !strcmp (argv[i], "microbench") || !strcmp (argv[i], "bench")
+	  || !strcmp (argv[i], "protocol") || !strcmp (argv[i], "match")
+	  || !strcmp (argv[i], "tune") || !strcmp (argv[i], "pdn")
+	  || !strcmp (argv[i], "pack") || !strcmp (argv[i], "unpack")
+	  || !strcmp (argv[i], "compact") || !strcmp (argv[i], "server"))
+	command = argv[i];
+      else if (command && (!strcmp (command, "batch") || !strcmp (command, "probcutfit")
+			   || !strcmp (command, "match") || !strcmp (command, "tune")
+			   || !strcmp (command, "pdn") || !strcmp (command, "pack")
+			   || !strcmp (command, "unpack") || !strcmp (command, "compact")
+			   || !strcmp (command, "server"))
+	       && !file && argv[i][0] != '-')
+	file = argv[i];
+      else if (!strcmp (argv[i], "-time") && i + 1 < argc)
+	lim.time = atof (argv[++i]);
+      else if (!strcmp (argv[i], "-depth") && i + 1 < argc)
+	lim.depth = atoi (argv[++i]);
+      else if (!strcmp (argv[i], "-nodes") && i + 1 < argc)
+	lim.nodes = atol (argv[++i]);
+      else if (!strcmp (argv[i], "-jobs") && i + 1 < argc)
+	jobs = atoi (argv[++i]);
+      else if (!strcmp (argv[i], "-format") && i + 1 < argc)
+	json = !strcmp (argv[++i], "json");
+      else if (!strcmp (argv[i], "-a") && i + 1 < argc)
+	config[0] = argv[++i];
+      else if (!strcmp (argv[i], "-b") && i + 1 < argc)
+	config[1] = argv[++i];
+      else if (!strcmp (argv[i], "-games") && i + 1 < argc)
+	games = atoi (argv[++i]);
+      else if (!strcmp (argv[i], "-elo0") && i + 1 < argc)
+	sprt[0] = atof (argv[++i]);
+      else if (!strcmp (argv[i], "-elo1") && i + 1 < argc)
+	sprt[1] = atof (argv[++i]);
+      else if (!strcmp (argv[i], "-alpha") && i + 1 < argc)
+	sprt[2] = atof (argv[++i]);
+      else if (!strcmp (argv[i], "-beta") && i + 1 < argc)
+	sprt[3] = atof (argv[++i]);
+      else if (!strcmp (argv[i], "-record") && i + 1 < argc)
+	record = argv[++i];
+      else if (!strcmp (argv[i], "-epochs") && i + 1 < argc)
+	epochs = atoi (argv[++i]);
+      else if (!strcmp (argv[i], "-check") && i + 1 < argc)
+	check = atoi (argv[++i]);
+      else if (!strcmp (argv[i], "-out") && i + 1 < argc)
+	out = argv[++i];
+      else if (!strcmp (argv[i], "-sessions") && i + 1 < argc)
+	sessions = atoi (argv[++i]);
+      else if (!strcmp (argv[i], "-queue") && i + 1 < argc)
+	queue = atoi (argv[++i]);
+      else if (argv[i][0] != '-' || i + 1 >= argc || !setoption (&opt, argv[i] + 1, argv[i + 1]))
+	{
+	  usage ();
+	  return (1);
+	}
+      else
+	i++;
+    }
+  /* these clear the hashtable between searches, a shared one is never
+     cleared: its results would depend on what else ran before */
+  if (command && opt.hashshm && (!strcmp (command, "batch") || !strcmp (command, "match")))
+    {
+      fprintf (stderr, "simplech: -hashshm cannot be used with %s\n", command);
+      return (1);
+    }
+  if (command && !strcmp (command, "match"))
+    {
+      if (!lim.time && !lim.depth && !lim.nodes)
+	lim.time = 0.1;
+      return (match (file, &opt, config, &lim, games, sprt, jobs, record));
+    }
+  if (command && !strcmp (command, "tune"))
+    {
+      if (!file)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (tune (file, &opt, epochs, jobs));
+    }
+  if (command && !strcmp (command, "pdn"))
+    {
+      if (!file)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (pdncommand (file, out, check));
+    }
+  if (command && !strcmp (command, "pack"))
+    {
+      if (!file || !out)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (pack (file, out));
+    }
+  if (command && !strcmp (command, "unpack"))
+    {
+      if (!file)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (unpack (file));
+    }
+  if (command && !strcmp (command, "compact"))
+    {
+      if (!file || !out)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (compactstore (file, out));
+    }
+  if (!lim.time && !lim.depth && !lim.nodes)
+    lim.time = 1.0;
+  if (command && !strcmp (command, "smpbench"))
+    {
+      smpbenchmark (&opt, lim.time);
+      return (0);
+    }
+  if (command && !strcmp (command, "driverbench"))
+    {
+      driverbenchmark (&opt, lim.depth ? lim.depth : 12);
+      return (0);
+    }
+  if (command && !strcmp (command, "selectbench"))
+    {
+      selectbenchmark (&opt, lim.depth ? lim.depth : 12);
+      return (0);
+    }
+  if (command && !strcmp (command, "probcutfit"))
+    {
+      probcutfit (file, &opt, lim.depth ? lim.depth : 10);
+      return (0);
+    }
+  if (command && !strcmp (command, "protocol"))
+    return (protocol (&opt));
+  if (command && !strcmp (command, "server"))
+    {
+      if (!file)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (server (file, &opt, jobs, sessions, queue));
+    }
+  if (command && !strcmp (command, "bench"))
+    {
+      benchmark (&opt, lim.depth ? lim.depth : BENCHDEPTH);
+      return (0);
+    }
+  if (command && !strcmp (command, "microbench"))
+    {
+      microbenchmark (json);
+      return (0);
+    }
+  if (command && !strcmp (command, "perft"))
+    {
+      perftcommand (lim.depth ? lim.depth : 10);
+      return (0);
+    }
+  if (command && !strcmp (command, "batch"))
+    {
+      if (!file)
+	{
+	  usage ();
+	  return (1);
+	}
+      return (batchanalysis (file, &opt, &lim, jobs));
+    }
+  if ((e = newengine (&opt)) == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      return (1);
+    }
+  e->out = stdout;
 
 #ifdef WIN95
 /*----------> WIN95: get a new console, set its title, input and output */
@@ -253,8 +1176,11 @@ main ()
 	      n -= 48;
 	      if (n < 10 && n > 0)
 		{
+		  /* a game clock for about 60 moves of maxtime each */
 		  n *= n;
 		  maxtime *= n;
+		  game.remaining = 60 * maxtime;
+		  game.increment = maxtime;
 		  i = 0;
 		}
 	    }
@@ -271,11 +1197,14 @@ main ()
 	break;
 
       initcheckers (b);
+      gamestart (e, b, BLACK);
 
       if (program == BLACK)
 	{
 	  printboard (human, b, program);
-	  checkers (b, program, maxtime, &str[0]);
+	  start = walltime ();
+	  enginemove (e, b, program, &game, &str[0]);
+	  game.remaining += game.increment - (walltime () - start);
 	}
 
       do
@@ -301,7 +1230,10 @@ main ()
 	      len += sprintf (buf + len, "%c: %s ", i + 97, str);
 	    }
 	  printf ("\nyour move? (t tests, z leaves)  ");
+	  if (opt.ponder)
+	    startponder (&pd, e, b, human);
 	  scanf ("%70s", &str[0]);
+	  stopponder (&pd);
 	  if (strstr (str, "new"))
 	    {
 	      askme = 2;
@@ -319,7 +1251,7 @@ main ()
 	  if (choice == 20)
 	    {
 	      printf ("\ntesting, please be patient\n");
-	      timerroutine (human, b);
+	      microbenchmark (0);
 	      continue;
 	    }
 	  if (choice == 26)
@@ -332,12 +1264,29 @@ main ()
 	      continue;
 	    }
 	  domove (b, movelist[choice - 1]);
+	  if (gamemove (e, movelist[choice - 1]) >= 2)
+	    {
+	      printboard (human, b, program);
+	      printf ("draw by repetition\n");
+	      break;
+	    }
 	  printboard (human, b, program);
-	  if (!checkers (b, program, maxtime, &str[0]))
+	  start = walltime ();
+	  if (!enginemove (e, b, program, &game, &str[0]))
 	    {
 	      printf ("you win!\n");
 	      break;
 	    }
+	  if (gamerepetitions (e) >= 2)
+	    {
+	      printboard (human, b, human);
+	      printf ("draw by repetition\n");
+	      break;
+	    }
+	  /* the program is never out of time against a human */
+	  game.remaining += game.increment - (walltime () - start);
+	  if (game.remaining < game.increment)
+	    game.remaining = game.increment;
 #ifdef VERBOSE
 	  printf ("%s", str);
 #endif
@@ -366,8 +1315,12 @@ main ()
   printf ("\n8th october 98, 27th november 99");
   printf ("\nby martin fierz");
   printf ("\n");
+  if (opt.hashfile)
+    savehashtable (e, opt.hashfile);
+  freeengine (e);
   return (0);
 }
+#endif
 
 /* enables input of moves in the format here-there (pdn), e.g.  11-15,
  * looks up the move entered in the movelist and returns its position;
@@ -465,202 +1418,4316 @@ initcheckers (int b[46])
     b[i] = OCCUPIED;
 }
 
-void
-timerroutine (int human, int b[46])
-/*----------> purpose: time the other routines
+int
+setposition (int b[46], char *str)
+/*----------> purpose: set up board b from a string of 32 characters for the
+  ---------->          squares 1..32 in standard notation (- empty, b/w men,
+  ---------->          B/W kings) followed by the side to move, b or w,
+  ---------->          or from a fen string, see setfen.
+  ----------> returns the color to move, 0 if the string is malformed.
   ----------> version: 1.0
-  ----------> date: 24th october 97 */
+  ----------> date: 18th october 2026 */
 {
+  int i, square;
 
-#ifdef VERBOSE
-  printf ("\nno timing in verbose mode!");
-#else
-  int i;
-  double start, time;
-  struct move2 movelist[20];
-  double factor;
-  int capture;
-
-  start = clock ();
-  for (i = 0; i < 1000000; i++)
-    evaluation (b, human);
-  time = (clock () - start) / TICKS;
-  factor = (1.44 / time);
-  printf ("\n\nevaluations: time for 1M iterations is %2.2f s, %2.2f", time, factor);
-
-  start = clock ();
-  for (i = 0; i < 1000000; i++)
-    capture = testcapture (b, human);
-  time = (clock () - start) / TICKS;
-  factor = (2.44 / time);
-  printf ("\ntestcapture: time for 1M iterations is %2.2f s, %2.2f", time, factor);
+  if ((*str == 'B' || *str == 'W') && str[1] == ':')
+    return (setfen (b, str));
+  initcheckers (b);
+  for (i = 5; i <= 40; i++)
+    if (b[i] != OCCUPIED)
+      b[i] = FREE;
 
-  if (capture)
+  for (square = 1; square <= 32; square++, str++)
     {
-      start = clock ();
-      for (i = 0; i < 1000000; i++)
-	generatecapturelist (b, movelist, human);
-      time = (clock () - start) / TICKS;
-      printf ("\ncapturelist: time for 1M iterations is %2.2f s", time);
+      /* square 1 is in black's right corner, see movetonotation */
+      i = 5 + 4 * ((square - 1) / 4) + ((square - 1) / 4 + 1) / 2 + 3 - (square - 1) % 4;
+      switch (*str)
+	{
+	case '-':
+	case '.':
+	  break;
+	case 'b':
+	  b[i] = (BLACK | MAN);
+	  break;
+	case 'B':
+	  b[i] = (BLACK | KING);
+	  break;
+	case 'w':
+	  b[i] = (WHITE | MAN);
+	  break;
+	case 'W':
+	  b[i] = (WHITE | KING);
+	  break;
+	default:
+	  return (0);
+	}
     }
-  else
-    {
-      start = clock ();
-      for (i = 0; i < 1000000; i++)
-	generatemovelist (b, movelist, human);
-      time = (clock () - start) / TICKS;
-      factor = (2.44 / time);
-      printf ("\nmovelist: time for 1M iterations is %2.2f s, %2.2f", time, factor);
-    }
-
-  start = clock ();
-  for (i = 0; i < 2000000; i++)
-    domove (b, movelist[0]);
-  time = (clock () - start) / TICKS;
-  factor = (0.79 / time);
-  printf ("\ndomove: time for 2M iterations is %2.2f s, %2.2f\n\n", time, factor);
-  undomove (b, movelist[0]);	/* pch */
-#endif
+  while (isspace (*str))
+    str++;
+  if (tolower (*str) == 'b')
+    return (BLACK);
+  if (tolower (*str) == 'w')
+    return (WHITE);
+  return (0);
 }
 
 void
-printboard (int human, int b[46], int color)
-/*----------> purpose: print the checkerboard
-  ----------> version: 1.0
-  ----------> date: 24th october 97 */
-/*----------> modified pch, to print
-  ----------> reverse board, 99-02-09 */
+positionstring (int b[46], int color, char str[36])
+/*----------> purpose: write board b with color to move to str in the format
+  ---------->          of setposition. */
 {
-  int i, j;
-  char c[18] = "     wb  WB     --";
+  int i, square;
 
-  if (human == BLACK)
+  for (square = 1; square <= 32; square++)
     {
-      if (color == BLACK)
-	printf ("\n   --------------- ");
-      else
-	printf ("\n.  --------------- ");
-      for (i = 37; i >= 10; i -= 9)
+      i = 5 + 4 * ((square - 1) / 4) + ((square - 1) / 4 + 1) / 2 + 3 - (square - 1) % 4;
+      switch (b[i])
 	{
-	  printf ("\n   ");
-	  for (j = i; j <= i + 3; j++)
-	    printf ("  %c ", c[b[j]]);
-	  printf ("\n   ");
-	  for (j = i - 5; j <= i - 2; j++)
-	    printf ("%c   ", c[b[j]]);
+	case BLACK | MAN:
+	  str[square - 1] = 'b';
+	  break;
+	case BLACK | KING:
+	  str[square - 1] = 'B';
+	  break;
+	case WHITE | MAN:
+	  str[square - 1] = 'w';
+	  break;
+	case WHITE | KING:
+	  str[square - 1] = 'W';
+	  break;
+	default:
+	  str[square - 1] = '-';
 	}
     }
+  str[32] = ' ';
+  str[33] = (color == BLACK) ? 'b' : 'w';
+  str[34] = 0;
+}
+
+int
+setfen (int b[46], char *str)
+/*----------> purpose: set up board b from a fen string like
+  ---------->          W:W21,22,K30:B1-3, the side to move, then the white
+  ---------->          and the black pieces: squares in standard notation,
+  ---------->          K for a king, ranges from-to. a final . and what
+  ---------->          follows a blank are ignored.
+  ----------> returns the color to move, 0 if the string is malformed.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int i, color, piece, king, from, to;
+
+  initcheckers (b);
+  for (i = 5; i <= 40; i++)
+    if (b[i] != OCCUPIED)
+      b[i] = FREE;
+
+  if (toupper (*str) == 'B')
+    color = BLACK;
+  else if (toupper (*str) == 'W')
+    color = WHITE;
   else
-    /* human == WHITE */
+    return (0);
+  for (str++; *str == ':'; )
     {
-      if (color == WHITE)
-	printf ("\n*  --------------- ");
+      str++;
+      if (toupper (*str) == 'B')
+	piece = BLACK;
+      else if (toupper (*str) == 'W')
+	piece = WHITE;
       else
-	printf ("\n-  --------------- ");
-      for (i = 10; i <= 37; i += 9)
+	return (0);
+      for (str++; *str && *str != ':' && *str != '.' && !isspace (*str);)
 	{
-	  printf ("\n   ");
-	  for (j = i - 2; j >= i - 5; j--)
-	    printf ("  %c ", c[b[j]]);
-	  printf ("\n   ");
-	  for (j = i + 3; j >= i; j--)
-	    printf ("%c   ", c[b[j]]);
+	  if ((king = (toupper (*str) == 'K')))
+	    str++;
+	  if (!isdigit (*str))
+	    return (0);
+	  from = to = strtol (str, &str, 10);
+	  if (*str == '-' && isdigit (str[1]))
+	    to = strtol (str + 1, &str, 10);
+	  if (from < 1 || to > 32 || from > to)
+	    return (0);
+	  for (i = from; i <= to; i++)
+	    b[squareindex (i)] = piece | (king ? KING : MAN);
+	  if (*str == ',')
+	    str++;
 	}
     }
-  printf ("\n\n");
+  if (*str && *str != '.' && !isspace (*str))
+    return (0);
+  return (color);
 }
 
-/*-------------- PART II: SEARCH --------------------------------------------*/
+void
+fenstring (int b[46], int color, char str[FENLENGTH])
+/*----------> purpose: write board b with color to move to str as a fen
+  ---------->          string for setfen, white pieces first, by square. */
+{
+  int len, square, piece, sep;
 
+  len = sprintf (str, "%c", color == BLACK ? 'B' : 'W');
+  for (piece = WHITE; piece <= BLACK; piece++)
+    {
+      len += sprintf (str + len, ":%c", piece == BLACK ? 'B' : 'W');
+      for (square = 1, sep = 0; square <= 32; square++)
+	if (b[squareindex (square)] != FREE && (b[squareindex (square)] & piece))
+	  len += sprintf (str + len, "%s%s%i", sep++ ? "," : "",
+			  b[squareindex (square)] & KING ? "K" : "", square);
+    }
+}
 
-int
-checkers (int b[46], int color, double maxtime, char *str)
-/*----------> purpose: entry point to checkers. find a move on board b for color
-  ---------->          in the time specified by maxtime, write the best move in
-  ---------->          board, returns information on the search in str
-  ----------> returns 1 if a move is found & executed, 0, if there is no legal
-  ----------> move in this position.
-  ----------> version: 1.1
-  ----------> date: 9th october 98 */
+void
+packposition (int b[46], int color, unsigned char record[RECORDSIZE])
+/*----------> purpose: pack board b with color to move into a record of
+  ---------->          RECORDSIZE bytes: the black pieces, the white pieces
+  ---------->          and the kings as 32 bit sets of the squares, bit
+  ---------->          square - 1, little endian; then 0 for black to move
+  ---------->          or 1 for white, and 3 bytes 0. */
 {
-  int i, numberofmoves;
-  double start;
-  int eval;
-  struct move2 best, movelist[MAXMOVES];
+  uint32_t set[3] = {0, 0, 0};
+  int i, square;
+
+  for (square = 1; square <= 32; square++)
+    {
+      i = squareindex (square);
+      if (b[i] == FREE)
+	continue;
+      set[(b[i] & BLACK) ? 0 : 1] |= (uint32_t) 1 << (square - 1);
+      if (b[i] & KING)
+	set[2] |= (uint32_t) 1 << (square - 1);
+    }
+  memset (record, 0, RECORDSIZE);
+  for (i = 0; i < 12; i++)
+    record[i] = set[i / 4] >> (8 * (i % 4));
+  record[12] = (color == WHITE);
+}
+
+int
+unpackposition (unsigned char record[RECORDSIZE], int b[46])
+/*----------> purpose: set up board b from a record of packposition.
+  ----------> returns the color to move, 0 if the record is not valid. */
+{
+  uint32_t set[3] = {0, 0, 0};
+  int i, square;
+
+  for (i = 0; i < 12; i++)
+    set[i / 4] |= (uint32_t) record[i] << (8 * (i % 4));
+  if ((set[0] & set[1]) || (set[2] & ~(set[0] | set[1])) || record[12] > 1
+      || record[13] || record[14] || record[15])
+    return (0);
+  initcheckers (b);
+  for (square = 1; square <= 32; square++)
+    {
+      i = squareindex (square);
+      b[i] = FREE;
+      if ((set[0] | set[1]) >> (square - 1) & 1)
+	b[i] = ((set[0] >> (square - 1) & 1) ? BLACK : WHITE)
+	  | ((set[2] >> (square - 1) & 1) ? KING : MAN);
+    }
+  return (record[12] ? WHITE : BLACK);
+}
+
+int
+pack (char *filename, char *out)
+/*----------> purpose: pack the positions of filename, one per line as for
+  ---------->          setposition, into records in out.
+  ----------> returns 0, 1 if a file cannot be read or written. */
+{
+  FILE *fp, *op;
+  char line[256];
+  unsigned char record[RECORDSIZE];
+  int b[46], color;
+  long n = 0, bad = 0;
+
+  if ((fp = fopen (filename, "r")) == NULL)
+    {
+      perror (filename);
+      return (1);
+    }
+  if ((op = fopen (out, "wb")) == NULL)
+    {
+      perror (out);
+      fclose (fp);
+      return (1);
+    }
+  while (fgets (line, sizeof (line), fp))
+    {
+      if (line[0] == '#' || line[0] == '\n')
+	continue;
+      if ((color = setposition (b, line)) == 0)
+	{
+	  bad++;
+	  continue;
+	}
+      packposition (b, color, record);
+      fwrite (record, RECORDSIZE, 1, op);
+      n++;
+    }
+  fclose (fp);
+  if (fclose (op))
+    {
+      perror (out);
+      return (1);
+    }
+  fprintf (stderr, "%li positions, %li bytes, %li lines not understood\n", n, n * RECORDSIZE, bad);
+  return (0);
+}
+
+int
+unpack (char *filename)
+/*----------> purpose: write the records of filename to stdout as fen.
+  ----------> returns 0, 1 if it cannot be read or has a bad record. */
+{
+  FILE *fp;
+  char str[FENLENGTH];
+  unsigned char record[RECORDSIZE];
+  int b[46], color;
+  long n = 0;
+
+  if ((fp = fopen (filename, "rb")) == NULL)
+    {
+      perror (filename);
+      return (1);
+    }
+  while (fread (record, RECORDSIZE, 1, fp) == 1)
+    {
+      if ((color = unpackposition (record, b)) == 0)
+	{
+	  fprintf (stderr, "simplech: %s: record %li is not valid\n", filename, n + 1);
+	  fclose (fp);
+	  return (1);
+	}
+      fenstring (b, color, str);
+      printf ("%s\n", str);
+      n++;
+    }
+  fclose (fp);
+  return (0);
+}
+
+int
+compactstore (char *filename, char *out)
+/*----------> purpose: copy the analysis store in filename to a new one in
+  ---------->          out with twice as many slots as results, at least
+  ---------->          2^10, so that every result is near its home slot
+  ---------->          again. torn entries are left behind. the store must
+  ---------->          not be in use while it is compacted.
+  ----------> returns 0, 1 if a store cannot be opened. */
+{
+  struct store *s, *c;
+  struct storeentry *h;
+  long n = 0, dropped = 0, torn = 0;
+  uint64_t i, key;
+  int bits;
+
+  if (!strcmp (filename, out))
+    {
+      fprintf (stderr, "simplech: compact %s into another file\n", filename);
+      return (1);
+    }
+  if ((s = openstore (filename, STOREBITS)) == NULL)
+    return (1);
+  for (i = 0; i <= s->mask; i++)
+    if (s->entry[i].lock || s->entry[i].data || s->entry[i].nodes)
+      n++;
+  for (bits = 10; ((uint64_t) 1 << bits) < 2 * (uint64_t) n; bits++)
+    ;
+  unlink (out);
+  if ((c = openstore (out, bits)) == NULL)
+    {
+      closestore (s);
+      return (1);
+    }
+  n = 0;
+  for (i = 0; i <= s->mask; i++)
+    {
+      h = &s->entry[i];
+      if (!h->lock && !h->data && !h->nodes)
+	continue;
+      /* the key is not stored, but the lock gives it back; a torn
+         entry gives a key whose probe never reaches slot i */
+      key = h->lock ^ h->data ^ h->nodes;
+      if (((i - key) & s->mask) >= STOREPROBE)
+	{
+	  torn++;
+	  continue;
+	}
+      if (storeupdate (c, key, (h->data >> 16) & 255,
+		       (int) (h->data & 0xffff) - 32768, (h->data >> 26) & 4095, h->nodes))
+	n++;
+      else
+	dropped++;
+    }
+  fprintf (stderr, "%li results, %li slots, was %li, %li not placed, %li torn\n",
+	   n, (long) (c->mask + 1), (long) (s->mask + 1), dropped, torn);
+  closestore (s);
+  closestore (c);
+  return (0);
+}
+
+int
+squareindex (int square)
+/*----------> purpose: the index in b of square 1..32 in standard notation */
+{
+  return (5 + 4 * ((square - 1) / 4) + ((square - 1) / 4 + 1) / 2 + 3 - (square - 1) % 4);
+}
+
+int
+squarenumber (int i)
+/*----------> purpose: the square in standard notation of index i in b, as
+  ---------->          movetonotation numbers it. */
+{
+  i -= i / 9 + 5;
+  return (i - i % 4 + 3 - i % 4 + 1);
+}
+
+void
+smpbenchmark (struct options *opt, double maxtime)
+/*----------> purpose: report the nodes/sec scaling of the lazy smp search
+  ---------->          from 1 to maxthreads threads on the bench positions,
+  ---------->          searching each for maxtime seconds.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int b[46];
+  int i, n, color, eval, depth;
+  int maxthreads = opt->threads;
+  long nodes;
+  double start, time, nps, basenps = 0;
+  struct move2 best;
+  struct engine *e;
+  struct limits lim = {0};
+
+  lim.time = maxtime;
+  printf ("threads      nodes    time     knps  speedup\n");
+  for (n = 1;; n *= 2)
+    {
+      if (n > maxthreads)
+	n = maxthreads;
+      opt->threads = n;
+      if ((e = newengine (opt)) == NULL)
+	break;
+      nodes = 0;
+      start = walltime ();
+      for (i = 0; i < (int) (sizeof (benchpositions) / sizeof (char *)); i++)
+	{
+	  color = setposition (b, benchpositions[i]);
+	  nodes += smpsearch (e, b, color, &lim, &best, &eval, &depth);
+	}
+      time = walltime () - start;
+      freeengine (e);
+      nps = nodes / time;
+      if (n == 1)
+	basenps = nps;
+      printf ("%7i %10li %7.2f %8.0f %8.2f\n", n, nodes, time, nps / 1000, nps / basenps);
+      if (n == maxthreads)
+	break;
+    }
+  opt->threads = maxthreads;
+}
+
+void
+benchmark (struct options *opt, int depth)
+/*----------> purpose: the node count signature of the search. searches the
+  ---------->          bench positions to depth with one thread, each from an
+  ---------->          empty hashtable and without a time limit, so that the
+  ---------->          total number of nodes depends only on the search and
+  ---------->          the options. a change that claims to be only a speedup
+  ---------->          must leave it unchanged.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int b[46];
+  int i, color, eval, reached;
+  long nodes, total = 0;
+  double start, time, totaltime = 0;
+  char str[80];
+  struct move2 best;
+  struct engine *e;
+  struct limits lim = {0};
+  struct options o = *opt;
+
+  o.threads = 1;
+  o.store = NULL;		/* a stored result would skip the search */
+  o.hashshm = NULL;		/* a shared hashtable is never cleared */
+  if ((e = newengine (&o)) == NULL)
+    return;
+  lim.depth = depth;
+  for (i = 0; i < (int) (sizeof (benchpositions) / sizeof (char *)); i++)
+    {
+      color = setposition (b, benchpositions[i]);
+      clearhashtable (e);
+      start = walltime ();
+      nodes = smpsearch (e, b, color, &lim, &best, &eval, &reached);
+      time = walltime () - start;
+      total += nodes;
+      totaltime += time;
+      movetonotation (best, str);
+      printf ("%2i %-36s %-7s %5i %10li %7.3f\n", i + 1, benchpositions[i], str, eval, nodes, time);
+    }
+  freeengine (e);
+  printf ("depth %i, hashbits %i\n", depth, o.hashbits);
+  printf ("nodes %li\n", total);
+  printf ("time %.3f s\n", totaltime);
+  printf ("nps %.0f\n", total / totaltime);
+}
+
+void
+driverbenchmark (struct options *opt, int depth)
+/*----------> purpose: search the bench positions to depth with the
+  ---------->          alphabeta and the mtdf driver, each from an empty
+  ---------->          hashtable, and compare nodes and time to depth.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int b[46];
+  int i, d, color, eval[2], reached;
+  long nodes[2], total[2] = {0, 0};
+  double start, time[2], totaltime[2] = {0, 0};
+  struct move2 best;
+  struct engine *e;
+  struct limits lim = {0};
+  char *name[2] = {"alphabeta", "mtdf"};
+
+  lim.depth = depth;
+  printf ("depth %i, %i threads\n", depth, opt->threads);
+  printf ("%-36s %10s %7s %5s %10s %7s %5s\n", "position", "alphabeta", "time", "eval", "mtdf", "time", "eval");
+  for (i = 0; i < (int) (sizeof (benchpositions) / sizeof (char *)); i++)
+    {
+      for (d = ALPHABETA; d <= MTDF; d++)
+	{
+	  opt->driver = d;
+	  if ((e = newengine (opt)) == NULL)
+	    return;
+	  color = setposition (b, benchpositions[i]);
+	  start = walltime ();
+	  nodes[d] = smpsearch (e, b, color, &lim, &best, &eval[d], &reached);
+	  time[d] = walltime () - start;
+	  total[d] += nodes[d];
+	  totaltime[d] += time[d];
+	  freeengine (e);
+	}
+      printf ("%-36s %10li %7.3f %5i %10li %7.3f %5i\n", benchpositions[i],
+	      nodes[0], time[0], eval[0], nodes[1], time[1], eval[1]);
+    }
+  printf ("%-36s %10li %7.3f %5s %10li %7.3f\n", "total", total[0], totaltime[0], "", total[1], totaltime[1]);
+  printf ("%s/%s: nodes %.3f, time %.3f\n", name[1], name[0],
+	  (double) total[1] / total[0], totaltime[1] / totaltime[0]);
+}
+
+void
+selectbenchmark (struct options *opt, int depth)
+/*----------> purpose: search the bench positions to depth with and without
+  ---------->          the selective search techniques and report the node
+  ---------->          and time savings against the full width search, and
+  ---------->          how often the best move differs from it.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int b[46];
+  int i, c, color, eval, reached;
+  int base[sizeof (benchpositions) / sizeof (char *)];
+  int differ;
+  long nodes, basenodes = 0;
+  double start, time, basetime = 0;
+  struct move2 best;
+  struct engine *e;
+  struct limits lim = {0};
+  struct options o;
+  int config[] = {0, 1, 2, 3, 4, 7};	/* lmr 1, futility 2, probcut 4 */
+  char *name[] = {"none", "lmr", "futility", "lmr+futility", "probcut", "all"};
+
+  lim.depth = depth;
+  printf ("depth %i, %i threads\n", depth, opt->threads);
+  printf ("%-14s %10s %7s %7s %7s %7s\n", "selective", "nodes", "time", "nodes%", "time%", "moves");
+  for (c = 0; c < (int) (sizeof (config) / sizeof (int)); c++)
+    {
+      o = *opt;
+      o.lmr = config[c] & 1;
+      o.futility = (config[c] & 2) != 0;
+      o.probcut = (config[c] & 4) != 0;
+      nodes = 0;
+      time = 0;
+      differ = 0;
+      for (i = 0; i < (int) (sizeof (benchpositions) / sizeof (char *)); i++)
+	{
+	  if ((e = newengine (&o)) == NULL)
+	    return;
+	  color = setposition (b, benchpositions[i]);
+	  start = walltime ();
+	  nodes += smpsearch (e, b, color, &lim, &best, &eval, &reached);
+	  time += walltime () - start;
+	  freeengine (e);
+	  if (c == 0)
+	    base[i] = movecode (best);
+	  else if (movecode (best) != base[i])
+	    differ++;
+	}
+      if (c == 0)
+	{
+	  basenodes = nodes;
+	  basetime = time;
+	}
+      printf ("%-14s %10li %7.3f %7.1f %7.1f %4i/%i\n", name[c], nodes, time,
+	      100.0 * nodes / basenodes, 100.0 * time / basetime, differ, i);
+    }
+}
+
+void
+probcutfit (char *filename, struct options *opt, int depth)
+/*----------> purpose: fit the probcut model. every position in filename (the
+  ---------->          bench positions if NULL) and every position after one
+  ---------->          move from it is searched to depth - PCREDUCE and to
+  ---------->          depth. the pairs of values are logged to stdout and
+  ---------->          fitted by least squares, deep = slope*shallow+offset.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  FILE *fp = NULL;
+  char line[256];
+  int b[46];
+  int i, j, n, c, color, reached, shallow, deep;
+  long samples = 0;
+  double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+  double slope, offset, sigma;
+  struct move2 best, movelist[MAXMOVES], replies[MAXMOVES];
+  struct engine *e;
+  struct limits lim = {0};
+  struct options o = *opt;
+
+  o.probcut = 0;
+  o.store = NULL;
+  if (filename && (fp = fopen (filename, "r")) == NULL)
+    {
+      perror (filename);
+      return;
+    }
+  if ((e = newengine (&o)) == NULL)
+    return;
+  printf ("# shallow depth %i, deep depth %i\n", depth - PCREDUCE, depth);
+  for (i = 0;; i++)
+    {
+      if (fp ? !fgets (line, sizeof (line), fp) : i >= (int) (sizeof (benchpositions) / sizeof (char *)))
+	break;
+      if ((color = setposition (b, fp ? line : benchpositions[i])) == 0)
+	continue;
+      if (testcapture (b, color))
+	n = generatecapturelist (b, movelist, color);
+      else
+	n = generatemovelist (b, movelist, color);
+      /* j == n is the position itself */
+      for (j = 0; j <= n; j++)
+	{
+	  if (j < n)
+	    domove (b, movelist[j]);
+	  c = (j < n) ? (color ^ CHANGECOLOR) : color;
+	  if (testcapture (b, c) || generatemovelist (b, replies, c))
+	    {
+	      clearhashtable (e);
+	      lim.depth = depth - PCREDUCE;
+	      smpsearch (e, b, c, &lim, &best, &shallow, &reached);
+	      clearhashtable (e);
+	      lim.depth = depth;
+	      smpsearch (e, b, c, &lim, &best, &deep, &reached);
+	      if (abs (shallow) < 4000 && abs (deep) < 4000)
+		{
+		  printf ("%i %i\n", shallow, deep);
+		  samples++;
+		  sx += shallow;
+		  sy += deep;
+		  sxx += (double) shallow * shallow;
+		  sxy += (double) shallow * deep;
+		  syy += (double) deep * deep;
+		}
+	    }
+	  if (j < n)
+	    undomove (b, movelist[j]);
+	}
+    }
+  if (fp)
+    fclose (fp);
+  freeengine (e);
+  if (samples < 3 || samples * sxx == sx * sx)
+    {
+      printf ("# not enough samples\n");
+      return;
+    }
+  slope = (samples * sxy - sx * sy) / (samples * sxx - sx * sx);
+  offset = (sy - slope * sx) / samples;
+  /* residual variance from the sums */
+  sigma = (syy - 2 * slope * sxy - 2 * offset * sy + slope * slope * sxx
+	   + 2 * slope * offset * sx + samples * offset * offset) / (samples - 2);
+  sigma = sqrt (sigma > 0 ? sigma : 0);
+  printf ("# %li samples: -pcslope %.3f -pcoffset %.2f -pcsigma %.2f\n", samples, slope, offset, sigma);
+}
+
+long
+perft (int b[46], int color, int depth)
+/*----------> purpose: count the leaf nodes of the move tree to depth, to
+  ---------->          verify the move generator against known numbers */
+{
+  int i, n;
+  long nodes = 0;
+  struct move2 movelist[MAXMOVES];
+
+  if (testcapture (b, color))
+    n = generatecapturelist (b, movelist, color);
+  else
+    n = generatemovelist (b, movelist, color);
+  if (depth <= 1)
+    return (n);
+  for (i = 0; i < n; i++)
+    {
+      domove (b, movelist[i]);
+      nodes += perft (b, color ^ CHANGECOLOR, depth - 1);
+      undomove (b, movelist[i]);
+    }
+  return (nodes);
+}
+
+void
+perftcommand (int depth)
+/*----------> purpose: perft from the starting position to depth, checked
+  ---------->          against the published counts
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  static const long known[] =
+  {1, 7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564,
+   85242128};
+  int b[46];
+  int d;
+  long nodes;
+  double start;
+
+  initcheckers (b);
+  for (d = 1; d <= depth; d++)
+    {
+      start = walltime ();
+      nodes = perft (b, BLACK, d);
+      printf ("perft %2i %12li %8.3f s", d, nodes, walltime () - start);
+      if (d < (int) (sizeof (known) / sizeof (long)))
+	printf (nodes == known[d] ? "  ok\n" : "  WRONG, should be %li\n", known[d]);
+      else
+	printf ("\n");
+    }
+}
+
+int
+batchanalysis (char *filename, struct options *opt, struct limits *lim, int jobs)
+/*----------> purpose: analyse every position in filename (one per line in
+  ---------->          the format of setposition, # starts a comment) with
+  ---------->          the limits lim on a pool of jobs threads, each with
+  ---------->          its own engine. writes one json line per position to
+  ---------->          stdout in input order, the totals to stderr.
+  ----------> returns 0, or 1 if the file cannot be read, memory runs out
+  ---------->          or no thread can be started.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  FILE *fp;
+  char line[256], *p, **more;
+  struct batch batch;
+  struct batchresult *r;
+  pthread_t *pool = NULL;
+  double start;
+  long nodes = 0;
+  int i, n, size = 1024, status = 0;
+
+  if ((fp = fopen (filename, "r")) == NULL)
+    {
+      perror (filename);
+      return (1);
+    }
+  memset (&batch, 0, sizeof (batch));
+  if ((batch.position = malloc (size * sizeof (char *))) == NULL)
+    status = 2;
+  while (status == 0 && fgets (line, sizeof (line), fp))
+    {
+      for (p = line; isspace (*p); p++)
+	;
+      if (*p == '\0' || *p == '#')
+	continue;
+      p[strcspn (p, "\r\n")] = '\0';
+      if (batch.n == size)
+	{
+	  if ((more = realloc (batch.position, 2 * size * sizeof (char *))) == NULL)
+	    {
+	      status = 2;
+	      break;
+	    }
+	  batch.position = more;
+	  size *= 2;
+	}
+      if ((batch.position[batch.n] = strdup (p)) == NULL)
+	status = 2;
+      else
+	batch.n++;
+    }
+  fclose (fp);
+
+  if (jobs <= 0)
+    jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  if (jobs > batch.n)
+    jobs = batch.n;
+  batch.opt = opt;
+  batch.lim = lim;
+  pthread_mutex_init (&batch.lock, NULL);
+  pthread_cond_init (&batch.done, NULL);
+  if (status == 0)
+    {
+      batch.result = calloc (batch.n + 1, sizeof (struct batchresult));
+      pool = malloc ((jobs + 1) * sizeof (pthread_t));
+      if (batch.result == NULL || pool == NULL)
+	status = 2;
+    }
+  if (status == 2)
+    fprintf (stderr, "simplech: out of memory\n");
+
+  start = walltime ();
+  for (n = 0; status == 0 && n < jobs; n++)
+    if (pthread_create (&pool[n], NULL, batchworker, &batch))
+      break;
+  if (status == 0 && n == 0 && batch.n > 0)
+    {
+      fprintf (stderr, "simplech: cannot start batch threads\n");
+      status = 1;
+    }
+  jobs = n;
+
+/*----------> print the results in input order as they come in */
+  for (i = 0; status == 0 && i < batch.n; i++)
+    {
+      r = &batch.result[i];
+      pthread_mutex_lock (&batch.lock);
+      if (!r->done)
+	{
+	  fflush (stdout);
+	  while (!r->done)
+	    pthread_cond_wait (&batch.done, &batch.lock);
+	}
+      pthread_mutex_unlock (&batch.lock);
+
+      printf ("{\"id\":%i,\"position\":", i + 1);
+      jsonstring (stdout, batch.position[i]);
+      if (r->status)
+	printf (",\"error\":\"%s\"}\n", r->status < 0 ? "bad position"
+		: r->status == 1 ? "no legal move" : "out of memory");
+      else
+	{
+	  printf (",\"move\":\"%s\",\"score\":%i,\"depth\":%i,\"nodes\":%li,\"time\":%.3f",
+		  r->move, r->eval, r->depth, r->nodes, r->time);
+	  if (r->stats)
+	    printf (",\"stats\":%s", r->stats);
+	  printf ("}\n");
+	}
+      nodes += r->nodes;
+      free (r->stats);
+    }
+  fflush (stdout);
+  for (n = 0; n < jobs; n++)
+    pthread_join (pool[n], NULL);
+
+  if (status == 0)
+    {
+      start = walltime () - start;
+      fprintf (stderr, "%i positions, %li nodes in %.2f s: %.1f positions/s, %.0f knps, %i threads\n",
+	       batch.n, nodes, start, batch.n / start, nodes / start / 1000, jobs);
+    }
+
+  for (i = 0; i < batch.n; i++)
+    free (batch.position[i]);
+  free (batch.position);
+  free (batch.result);
+  free (pool);
+  pthread_mutex_destroy (&batch.lock);
+  pthread_cond_destroy (&batch.done);
+  return (status ? 1 : 0);
+}
+
+void *
+batchworker (void *arg)
+/*----------> purpose: a thread of the batch pool; takes positions from the
+  ---------->          shared batch until none are left. the hashtable is
+  ---------->          cleared before each position, so that results do not
+  ---------->          depend on the order in which a worker gets them.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct batch *batch = arg;
+  struct batchresult *r;
+  struct engine *e;
+  struct move2 best, movelist[MAXMOVES];
+  int b[46];
+  int i, color;
+  double start;
+
+  e = newengine (batch->opt);
+  for (;;)
+    {
+      pthread_mutex_lock (&batch->lock);
+      i = batch->next++;
+      pthread_mutex_unlock (&batch->lock);
+      if (i >= batch->n)
+	break;
+      r = &batch->result[i];
+
+      if ((color = setposition (b, batch->position[i])) == 0)
+	r->status = -1;
+      else if (!generatecapturelist (b, movelist, color) && !generatemovelist (b, movelist, color))
+	r->status = 1;
+      else if (e == NULL)
+	r->status = 2;
+      else
+	{
+	  clearhashtable (e);
+	  start = walltime ();
+	  r->nodes = smpsearch (e, b, color, batch->lim, &best, &r->eval, &r->depth);
+	  r->time = walltime () - start;
+	  movetonotation (best, r->move);
+	  if (batch->opt->stats)
+	    r->stats = statsstring (e);
+	}
+
+      pthread_mutex_lock (&batch->lock);
+      r->done = 1;
+      pthread_cond_broadcast (&batch->done);
+      pthread_mutex_unlock (&batch->lock);
+    }
+  freeengine (e);
+  return (NULL);
+}
+
+int
+protocol (struct options *opt)
+/*----------> purpose: run as an engine process for a controlling program.
+  ---------->          commands are read from stdin one per line:
+  ---------->            isready                        readyok
+  ---------->            newgame                        start position, clear hashtable
+  ---------->            position start|<board> <b|w> [moves m ...]
+  ---------->            move m                         play m on the position
+  ---------->            go [ponder] [time s] [depth d] [nodes n] [btime s]
+  ---------->               [wtime s] [binc s] [winc s] [movestogo n]
+  ---------->            ponderhit
+  ---------->            stop
+  ---------->            setoption name value
+  ---------->            quit
+  ---------->          go searches on a thread of its own. isready, ponderhit,
+  ---------->          stop and quit are answered meanwhile, any other
+  ---------->          command waits for the search to end. without limits
+  ---------->          it searches until stop. it answers with an info line
+  ---------->          with the principal variation after each iteration,
+  ---------->          then an info line and bestmove m. go ponder searches
+  ---------->          the position after the move the opponent is
+  ---------->          expected to play; its limits only start at
+  ---------->          ponderhit, which says that move was played. if
+  ---------->          another move was played, the controller sends stop
+  ---------->          and searches the real position, on a hashtable
+  ---------->          warmed by the ponder search.
+  ---------->          the engine and its hashtable live as long as the
+  ---------->          process; stdout is fully buffered and flushed once
+  ---------->          per answer.
+  ----------> returns 0 at quit or end of input, 1 if out of memory.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  static char buffer[BUFSIZ];
+  struct protocol p;
+  char line[1024];
+
+  memset (&p, 0, sizeof (p));
+  if (!copyoptions (&p.opt, opt) || (p.e = newengine (&p.opt)) == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      freeoptions (&p.opt);
+      return (1);
+    }
+  pthread_mutex_init (&p.out, NULL);
+  p.fp = stdout;
+  setvbuf (stdout, buffer, _IOFBF, sizeof (buffer));
+  initcheckers (p.b);
+  p.color = BLACK;
+  gamestart (p.e, p.b, p.color);
+
+  while (fgets (line, sizeof (line), stdin))
+    {
+      line[strcspn (line, "\r\n")] = '\0';
+      if (!protocolcommand (&p, line))
+	break;
+    }
+  stopsearch (&p, 1);
+  freeengine (p.e);
+  freeoptions (&p.opt);
+  pthread_mutex_destroy (&p.out);
+  return (0);
+}
+
+int
+protocolcommand (struct protocol *p, char *line)
+/*----------> purpose: execute one command line of the protocol.
+  ----------> returns 0 for quit, 1 otherwise. */
+{
+  char *command, *name, *value, *rest;
+  struct limits lim = {0};
+  double btime = 0, wtime = 0, binc = 0, winc = 0;
+  struct options opt, engineopt;
+
+  if ((command = strtok_r (line, " \t", &rest)) == NULL)
+    return (1);
+
+  if (!strcmp (command, "quit"))
+    return (0);
+  else if (!strcmp (command, "isready"))
+    reply (p, "readyok");
+  else if (!strcmp (command, "stop"))
+    stopsearch (p, 1);
+  else if (!strcmp (command, "ponderhit"))
+    {
+      /* the expected move was played: the search goes on with its limits */
+      p->e->ponderhit = walltime ();
+      p->e->pondering = 0;
+    }
+  else if (!strcmp (command, "savehash") || !strcmp (command, "loadhash"))
+    {
+      stopsearch (p, 0);
+      if ((name = strtok_r (NULL, " \t", &rest)) == NULL)
+	name = p->opt.hashfile;
+      if (name == NULL)
+	reply (p, "error no file");
+      else if (command[0] == 's' ? savehashtable (p->e, name) : loadhashtable (p->e, name))
+	reply (p, "error %s", name);
+      else
+	reply (p, "%s %s", command[0] == 's' ? "saved" : "loaded", name);
+    }
+  else if (!strcmp (command, "newgame"))
+    {
+      stopsearch (p, 0);
+      clearhashtable (p->e);
+      initcheckers (p->b);
+      p->color = BLACK;
+      gamestart (p->e, p->b, p->color);
+    }
+  else if (!strcmp (command, "position"))
+    {
+      stopsearch (p, 0);
+      if (!protocolposition (p, rest))
+	reply (p, "error bad position");
+    }
+  else if (!strcmp (command, "move"))
+    {
+      stopsearch (p, 0);
+      if ((name = strtok_r (NULL, " \t", &rest)) == NULL || !playmove (p->e, p->b, &p->color, name))
+	reply (p, "error illegal move");
+    }
+  else if (!strcmp (command, "setoption"))
+    {
+      stopsearch (p, 0);
+      name = strtok_r (NULL, " \t", &rest);
+      value = strtok_r (NULL, " \t", &rest);
+      if (!copyoptions (&opt, &p->opt))
+	reply (p, "error out of memory");
+      else if (name == NULL || value == NULL || !setoption (&opt, name, value))
+	{
+	  reply (p, "error unknown option");
+	  freeoptions (&opt);
+	}
+      else if (opt.hashbits != p->opt.hashbits || !samename (opt.store, p->opt.store)
+	       || !samename (opt.hashshm, p->opt.hashshm))
+	{
+	  /* a new hashtable or store, the game goes on */
+	  struct engine *e = newengine (&opt);
+
+	  if (e == NULL)
+	    {
+	      reply (p, "error out of memory");
+	      freeoptions (&opt);
+	    }
+	  else
+	    {
+	      memcpy (e->game, p->e->game, sizeof (e->game));
+	      e->gameplies = p->e->gameplies;
+	      e->gamereversible = p->e->gamereversible;
+	      freeengine (p->e);
+	      p->e = e;
+	      freeoptions (&p->opt);
+	      p->opt = opt;
+	    }
+	}
+      else if (!copyoptions (&engineopt, &opt))
+	{
+	  reply (p, "error out of memory");
+	  freeoptions (&opt);
+	}
+      else
+	{
+	  freeoptions (&p->e->opt);
+	  p->e->opt = engineopt;
+	  freeoptions (&p->opt);
+	  p->opt = opt;
+	}
+    }
+  else if (!strcmp (command, "go"))
+    {
+      stopsearch (p, 0);
+      p->e->pondering = 0;
+      while ((name = strtok_r (NULL, " \t", &rest)) != NULL)
+	{
+	  if (!strcmp (name, "ponder"))
+	    {
+	      p->e->pondering = 1;
+	      continue;
+	    }
+	  if ((value = strtok_r (NULL, " \t", &rest)) == NULL)
+	    break;
+	  if (!strcmp (name, "time"))
+	    lim.time = atof (value);
+	  else if (!strcmp (name, "depth"))
+	    lim.depth = atoi (value);
+	  else if (!strcmp (name, "nodes"))
+	    lim.nodes = atol (value);
+	  else if (!strcmp (name, "btime"))
+	    btime = atof (value);
+	  else if (!strcmp (name, "wtime"))
+	    wtime = atof (value);
+	  else if (!strcmp (name, "binc"))
+	    binc = atof (value);
+	  else if (!strcmp (name, "winc"))
+	    winc = atof (value);
+	  else if (!strcmp (name, "movestogo"))
+	    lim.movestogo = atoi (value);
+	}
+      lim.remaining = (p->color == BLACK) ? btime : wtime;
+      lim.increment = (p->color == BLACK) ? binc : winc;
+      if (p->served)
+	p->search = newsearch (p->e, p->b, p->color, &lim, protocolinfo, p);
+      else
+	p->search = startsearch (p->e, p->b, p->color, &lim, protocolinfo, p);
+      if (p->search == NULL)
+	reply (p, "error cannot start search");
+    }
+  else
+    reply (p, "error unknown command %s", command);
+  return (1);
+}
+
+int
+protocolposition (struct protocol *p, char *args)
+/*----------> purpose: the arguments of the position command: start, fen and
+  ---------->          a fen string, or a board and the side to move, then
+  ---------->          optionally moves
+  ---------->          played from there. the moves are the game history.
+  ----------> returns 1, or 0 if the board or a move is wrong. */
+{
+  char *token, *side, *rest, str[80];
+  int b[46], color;
+
+  if ((token = strtok_r (args, " \t", &rest)) == NULL)
+    return (0);
+  if (!strcmp (token, "start"))
+    {
+      initcheckers (b);
+      color = BLACK;
+    }
+  else if (!strcmp (token, "fen"))
+    {
+      if ((token = strtok_r (NULL, " \t", &rest)) == NULL || (color = setfen (b, token)) == 0)
+	return (0);
+    }
+  else
+    {
+      if ((side = strtok_r (NULL, " \t", &rest)) == NULL || strlen (token) != 32)
+	return (0);
+      sprintf (str, "%s %s", token, side);
+      if ((color = setposition (b, str)) == 0)
+	return (0);
+    }
+  gamestart (p->e, b, color);
+  if ((token = strtok_r (NULL, " \t", &rest)) != NULL && !strcmp (token, "moves"))
+    while ((token = strtok_r (NULL, " \t", &rest)) != NULL)
+      if (!playmove (p->e, b, &color, token))
+	return (0);
+  memcpy (p->b, b, sizeof (p->b));
+  p->color = color;
+  return (1);
+}
+
+int
+playmove (struct engine *e, int b[46], int *color, char *notation)
+/*----------> purpose: play the move in notation, from-to as movetonotation
+  ---------->          writes it, x for - is accepted. of two captures with
+  ---------->          the same from and to square the first is played.
+  ----------> returns 1, or 0 if there is no such move. */
+{
+  struct move2 movelist[MAXMOVES];
+  char str[80], *x;
+  int i, n;
+
+  if ((x = strchr (notation, 'x')) != NULL)
+    *x = '-';
+  n = generatecapturelist (b, movelist, *color);
+  if (n == 0)
+    n = generatemovelist (b, movelist, *color);
+  for (i = 0; i < n; i++)
+    {
+      movetonotation (movelist[i], str);
+      if (!strcmp (str, notation))
+	{
+	  domove (b, movelist[i]);
+	  gamemove (e, movelist[i]);
+	  *color ^= CHANGECOLOR;
+	  return (1);
+	}
+    }
+  return (0);
+}
+
+void
+protocolinfo (struct searchinfo *info, void *arg)
+/*----------> purpose: the progress of the search of the go command: an
+  ---------->          info line after each iteration; at the end the
+  ---------->          statistics, the last info line and bestmove, with
+  ---------->          the reply the search expects to ponder on. */
+{
+  struct protocol *p = arg;
+  char pv[MAXPV * 80], str[80], *stats;
+  int i;
+
+  for (pv[0] = '\0', i = 0; i < info->pvlength; i++)
+    {
+      movetonotation (info->pv[i], str);
+      strcat (pv, " ");
+      strcat (pv, str);
+    }
+  if (!info->done)
+    {
+      reply (p, "info depth %i score %i nodes %li time %.3f pv%s",
+	     info->depth, info->value, info->nodes, info->time, pv);
+      return;
+    }
+  if (info->pvlength == 0)
+    {
+      reply (p, "bestmove none");
+      return;
+    }
+  if (p->opt.stats && (stats = statsstring (p->e)) != NULL)
+    {
+      reply (p, "info stats %s", stats);
+      free (stats);
+    }
+  reply (p, "info depth %i score %i nodes %li time %.3f nps %.0f",
+	 info->depth, info->value, info->nodes, info->time,
+	 info->time > 0 ? info->nodes / info->time : 0.0);
+  movetonotation (info->pv[0], str);
+  if (info->pvlength > 1)
+    {
+      movetonotation (info->pv[1], pv);
+      reply (p, "bestmove %s ponder %s", str, pv);
+    }
+  else
+    reply (p, "bestmove %s", str);
+}
+
+void
+stopsearch (struct protocol *p, int now)
+/*----------> purpose: wait for the search of the go command, if there is
+  ---------->          one, to give its bestmove; stop it first if now */
+{
+  if (p->search == NULL)
+    return;
+  if (now)
+    cancelsearch (p->search);
+  waitsearch (p->search, NULL);
+  p->search = NULL;
+}
+
+void
+reply (struct protocol *p, char *format, ...)
+/*----------> purpose: write one line to p->fp and flush it. the line of a
+  ---------->          server session is added to p->output instead, for
+  ---------->          the poll thread to write when the connection takes
+  ---------->          it: a client which does not read stalls no thread.
+  ---------->          more than SESSIONOUTPUT bytes unread break the
+  ---------->          session. */
+{
+  va_list args;
+  char line[4096], *output;
+  size_t n, size;
+
+  pthread_mutex_lock (&p->out);
+  va_start (args, format);
+  if (!p->served)
+    {
+      vfprintf (p->fp, format, args);
+      putc ('\n', p->fp);
+      fflush (p->fp);
+    }
+  else if (!p->broken)
+    {
+      n = vsnprintf (line, sizeof (line) - 1, format, args);
+      if (n > sizeof (line) - 2)
+	n = sizeof (line) - 2;
+      line[n++] = '\n';
+      size = p->outputsize ? p->outputsize : sizeof (line);
+      while (size < p->outputlength + n)
+	size *= 2;
+      if (p->outputlength + n > SESSIONOUTPUT)
+	p->broken = 1;
+      else if (size > p->outputsize && (output = realloc (p->output, size)) == NULL)
+	p->broken = 1;
+      else
+	{
+	  if (size > p->outputsize)
+	    {
+	      p->output = output;
+	      p->outputsize = size;
+	    }
+	  memcpy (p->output + p->outputlength, line, n);
+	  p->outputlength += n;
+	}
+      /* a full pipe has woken the poll thread already */
+      n = write (p->wake, "", 1);
+    }
+  va_end (args);
+  pthread_mutex_unlock (&p->out);
+}
+
+int
+match (char *filename, struct options *opt, char *config[2], struct limits *lim, int games, double sprt[4], int jobs, char *record)
+/*----------> purpose: play engine a against engine b on a pool of jobs
+  ---------->          threads. both start from opt, changed by the option
+  ---------->          value pairs in config. each opening, from filename or
+  ---------->          the balanced 3-move openings, is played twice with
+  ---------->          the colors swapped. every move is searched with the
+  ---------->          limits lim. one json line per game goes to stdout as
+  ---------->          it ends, the standing to stderr. a sequential
+  ---------->          probability ratio test of elo sprt[0] against
+  ---------->          sprt[1], with error rates sprt[2] and sprt[3], stops
+  ---------->          the match as soon as it decides. with record, every
+  ---------->          position played goes to that file with the result
+  ---------->          of its game, the input of tune.
+  ----------> returns 0, or 1 if the options or openings are wrong, memory
+  ---------->          runs out or no thread can be started.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct match m;
+  pthread_t *pool;
+  char *name, *value, *rest, *str;
+  double elo, margin, llr;
+  int i, n, status = 1;
+
+  memset (&m, 0, sizeof (m));
+  for (i = 0; i < 2; i++)
+    {
+      if (!copyoptions (&m.opt[i], opt) || (str = strdup (config[i])) == NULL)
+	{
+	  fprintf (stderr, "simplech: out of memory\n");
+	  freeoptions (&m.opt[0]);
+	  freeoptions (&m.opt[1]);
+	  return (1);
+	}
+      for (name = strtok_r (str, " \t", &rest); name; name = strtok_r (NULL, " \t", &rest))
+	if ((value = strtok_r (NULL, " \t", &rest)) == NULL || !setoption (&m.opt[i], name, value))
+	  {
+	    fprintf (stderr, "simplech: engine %c: bad option %s\n", 'a' + i, name);
+	    free (str);
+	    freeoptions (&m.opt[0]);
+	    freeoptions (&m.opt[1]);
+	    return (1);
+	  }
+      free (str);
+    }
+  if (!loadopenings (&m, filename))
+    {
+      freeoptions (&m.opt[0]);
+      freeoptions (&m.opt[1]);
+      return (1);
+    }
+  if (record && (m.record = fopen (record, "w")) == NULL)
+    {
+      perror (record);
+      freeoptions (&m.opt[0]);
+      freeoptions (&m.opt[1]);
+      return (1);
+    }
+  m.lim = lim;
+  m.games = games ? games : 2 * m.openings;
+  m.elo0 = sprt[0];
+  m.elo1 = sprt[1];
+  m.alpha = sprt[2];
+  m.beta = sprt[3];
+  pthread_mutex_init (&m.lock, NULL);
+
+  if (jobs <= 0)
+    jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  if (jobs > m.games)
+    jobs = m.games;
+  if ((pool = malloc (jobs * sizeof (pthread_t))) == NULL)
+    fprintf (stderr, "simplech: out of memory\n");
+  else
+    {
+      fprintf (stderr, "%i openings, %i games, %i jobs\n", m.openings, m.games, jobs);
+      m.start = walltime ();
+      for (n = 0; n < jobs; n++)
+	if (pthread_create (&pool[n], NULL, matchworker, &m))
+	  break;
+      for (i = 0; i < n; i++)
+	pthread_join (pool[i], NULL);
+      if (n == 0)
+	fprintf (stderr, "simplech: cannot start match threads\n");
+      else
+	{
+	  llr = sprtllr (&m, &elo, &margin);
+	  fprintf (stderr, "games %i: +%i =%i -%i, elo %+.1f +- %.1f, llr %.2f (%.2f, %.2f), %s\n",
+		   m.played, m.wins, m.draws, m.losses, elo, margin, llr,
+		   log (m.beta / (1 - m.alpha)), log ((1 - m.beta) / m.alpha),
+		   m.decided > 0 ? "h1 accepted" : m.decided < 0 ? "h0 accepted" : "undecided");
+	  status = 0;
+	}
+    }
+  if (m.record)
+    fclose (m.record);
+  free (m.board);
+  free (m.color);
+  free (pool);
+  freeoptions (&m.opt[0]);
+  freeoptions (&m.opt[1]);
+  pthread_mutex_destroy (&m.lock);
+  return (status);
+}
+
+int
+loadopenings (struct match *m, char *filename)
+/*----------> purpose: read the openings of m from filename, one position per
+  ---------->          line as for setposition, or without a file take the
+  ---------->          positions after 3 plies from the start which a depth
+  ---------->          8 search scores within 40 of even.
+  ----------> returns the number of openings, 0 on error. */
+{
+  FILE *fp;
+  char line[256];
+  int b[46], b1[46], b2[46];
+  int i, j, k, l, n1, n2, n3, color, eval, depth, size = 64, full = 0;
+  uint64_t key, *seen = NULL;
+  struct move2 m1[MAXMOVES], m2[MAXMOVES], m3[MAXMOVES], best;
+  struct limits lim = {0};
+  struct engine *e;
+
+  m->board = malloc (size * sizeof (*m->board));
+  m->color = malloc (size * sizeof (int));
+  if (m->board == NULL || m->color == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      return (dropopenings (m));
+    }
+  if (filename)
+    {
+      if ((fp = fopen (filename, "r")) == NULL)
+	{
+	  perror (filename);
+	  return (dropopenings (m));
+	}
+      while (fgets (line, sizeof (line), fp))
+	if (line[0] != '#' && (color = setposition (b, line)) != 0
+	    && !addopening (m, &size, b, color))
+	  {
+	    fprintf (stderr, "simplech: out of memory\n");
+	    fclose (fp);
+	    return (dropopenings (m));
+	  }
+      fclose (fp);
+      if (m->openings == 0)
+	{
+	  fprintf (stderr, "simplech: no openings in %s\n", filename);
+	  return (dropopenings (m));
+	}
+      return (m->openings);
+    }
+
+/*----------> all distinct positions 3 plies deep, if they are balanced */
+  if ((e = newengine (&m->opt[0])) == NULL || (seen = malloc (1000 * sizeof (uint64_t))) == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      freeengine (e);
+      return (dropopenings (m));
+    }
+  lim.depth = 8;
+  initcheckers (b);
+  n1 = generatemovelist (b, m1, BLACK);
+  for (i = 0; i < n1; i++)
+    {
+      memcpy (b1, b, sizeof (b));
+      domove (b1, m1[i]);
+      if ((n2 = generatecapturelist (b1, m2, WHITE)) == 0)
+	n2 = generatemovelist (b1, m2, WHITE);
+      for (j = 0; j < n2; j++)
+	{
+	  memcpy (b2, b1, sizeof (b));
+	  domove (b2, m2[j]);
+	  if ((n3 = generatecapturelist (b2, m3, BLACK)) == 0)
+	    n3 = generatemovelist (b2, m3, BLACK);
+	  for (k = 0; k < n3; k++)
+	    {
+	      domove (b2, m3[k]);
+	      key = hashposition (b2, WHITE);
+	      for (l = 0; l < m->openings && seen[l] != key; l++)
+		;
+	      if (l == m->openings)
+		{
+		  clearhashtable (e);
+		  smpsearch (e, b2, WHITE, &lim, &best, &eval, &depth);
+		  if (abs (eval) <= 40 && m->openings < 1000 && !full)
+		    {
+		      seen[m->openings] = key;
+		      full = !addopening (m, &size, b2, WHITE);
+		    }
+		}
+	      undomove (b2, m3[k]);
+	    }
+	}
+    }
+  free (seen);
+  freeengine (e);
+  if (full)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      return (dropopenings (m));
+    }
+  return (m->openings);
+}
+
+int
+addopening (struct match *m, int *size, int b[46], int color)
+/*----------> purpose: append the opening b with color to move to m, doubling
+  ---------->          its *size if it is full.
+  ----------> returns 0 if out of memory, with m as it was. */
+{
+  int (*board)[46];
+  int *colors;
+
+  if (m->openings == *size)
+    {
+      if ((board = realloc (m->board, 2 * *size * sizeof (*m->board))) != NULL)
+	m->board = board;
+      if ((colors = realloc (m->color, 2 * *size * sizeof (int))) != NULL)
+	m->color = colors;
+      if (board == NULL || colors == NULL)
+	return (0);
+      *size *= 2;
+    }
+  memcpy (m->board[m->openings], b, sizeof (m->board[0]));
+  m->color[m->openings++] = color;
+  return (1);
+}
+
+int
+dropopenings (struct match *m)
+/*----------> purpose: forget the openings of m after an error.
+  ----------> returns 0. */
+{
+  free (m->board);
+  free (m->color);
+  m->board = NULL;
+  m->color = NULL;
+  m->openings = 0;
+  return (0);
+}
+
+void *
+matchworker (void *arg)
+/*----------> purpose: a thread of the match pool. plays games until all are
+  ---------->          handed out or the sprt has decided. game g is opening
+  ---------->          g/2, with engine a black in the even games. */
+{
+  struct match *m = arg;
+  struct engine *e[2];
+  int b[46];
+  char positions[MAXPLIES + 1][36];
+  int g, i, result, plies;
+  char *reason;
+  double elo, margin, llr, hours;
+
+  e[0] = newengine (&m->opt[0]);
+  e[1] = newengine (&m->opt[1]);
+  while (e[0] && e[1])
+    {
+      pthread_mutex_lock (&m->lock);
+      g = m->decided ? m->games : m->next++;
+      pthread_mutex_unlock (&m->lock);
+      if (g >= m->games)
+	break;
+
+      memcpy (b, m->board[(g / 2) % m->openings], sizeof (b));
+      clearhashtable (e[0]);
+      clearhashtable (e[1]);
+      /* result for black: 1 win, 0 draw, -1 loss */
+      if (g % 2 == 0)
+	result = playgame (m, e[0], e[1], b, m->color[(g / 2) % m->openings], &plies, &reason, positions);
+      else
+	result = -playgame (m, e[1], e[0], b, m->color[(g / 2) % m->openings], &plies, &reason, positions);
+
+      pthread_mutex_lock (&m->lock);
+      m->played++;
+      if (result > 0)
+	m->wins++;
+      else if (result < 0)
+	m->losses++;
+      else
+	m->draws++;
+      llr = sprtllr (m, &elo, &margin);
+      if (!m->decided && llr >= log ((1 - m->beta) / m->alpha))
+	m->decided = 1;
+      if (!m->decided && llr <= log (m->beta / (1 - m->alpha)))
+	m->decided = -1;
+      hours = (walltime () - m->start) / 3600;
+      printf ("{\"game\":%i,\"opening\":%i,\"black\":\"%c\",\"result\":\"%s\",\"plies\":%i,\"reason\":\"%s\"}\n",
+	      g + 1, (g / 2) % m->openings + 1, g % 2 ? 'b' : 'a',
+	      (result > 0) == (g % 2 == 0) && result ? "1-0" : result ? "0-1" : "1/2",
+	      plies, reason);
+      fflush (stdout);
+      for (i = 0; m->record && i <= plies && i <= MAXPLIES; i++)
+	fprintf (m->record, "%s %s\n", positions[i],
+		 (result > 0) == (g % 2 == 0) && result ? "1-0" : result ? "0-1" : "1/2");
+      fprintf (stderr, "games %i: +%i =%i -%i, elo %+.1f +- %.1f, llr %.2f, %.0f games/hour\n",
+	       m->played, m->wins, m->draws, m->losses, elo, margin, llr, m->played / hours);
+      pthread_mutex_unlock (&m->lock);
+    }
+  freeengine (e[0]);
+  freeengine (e[1]);
+  return (NULL);
+}
+
+int
+playgame (struct match *m, struct engine *black, struct engine *white, int b[46], int color, int *plies, char **reason, char positions[][36])
+/*----------> purpose: play one game from b with color to move.
+  ----------> returns 1 if black wins, -1 if white wins, 0 for a draw, the
+  ---------->          number of plies, why it ended and the positions of
+  ---------->          the game, the last included. */
+{
+  struct engine *e;
+  struct move2 best, movelist[MAXMOVES];
+  int n, eval, depth, agree = 0, last = 0;
+
+  gamestart (black, b, color);
+  gamestart (white, b, color);
+  for (*plies = 0;; (*plies)++)
+    {
+      positionstring (b, color, positions[*plies]);
+      n = generatecapturelist (b, movelist, color);
+      if (n == 0)
+	n = generatemovelist (b, movelist, color);
+      if (n == 0)
+	{
+	  *reason = "no move";
+	  return (color == BLACK ? -1 : 1);
+	}
+      if (gamerepetitions (black) >= 2)
+	{
+	  *reason = "repetition";
+	  return (0);
+	}
+      if (black->gamereversible >= DRAWPLIES || *plies >= MAXPLIES)
+	{
+	  *reason = "no progress";
+	  return (0);
+	}
+      e = (color == BLACK) ? black : white;
+      if (n == 1)
+	best = movelist[0];
+      else
+	{
+	  smpsearch (e, b, color, m->lim, &best, &eval, &depth);
+/*----------> adjudicate when the engines agree for long enough */
+	  if (abs (eval) >= ADJWIN && (last == 0 || (eval > 0) == (last > 0)))
+	    agree++;
+	  else
+	    agree = 0;
+	  last = eval;
+	  if (agree >= ADJPLIES)
+	    {
+	      *reason = "adjudicated";
+	      return (eval > 0 ? 1 : -1);
+	    }
+	}
+      domove (b, best);
+      gamemove (black, best);
+      gamemove (white, best);
+      color ^= CHANGECOLOR;
+    }
+}
+
+double
+sprtllr (struct match *m, double *elo, double *margin)
+/*----------> purpose: the log likelihood ratio of the results of m for elo1
+  ---------->          against elo0, in the normal approximation of the
+  ---------->          trinomial gsprt. *elo is the estimate and *margin its
+  ---------->          95% confidence half width. */
+{
+  double n = m->wins + m->draws + m->losses;
+  double score, var, s0, s1, slope;
+
+  *elo = *margin = 0;
+  if (n == 0)
+    return (0);
+  score = (m->wins + 0.5 * m->draws) / n;
+  var = (m->wins * (1 - score) * (1 - score) + m->draws * (0.5 - score) * (0.5 - score)
+	 + m->losses * score * score) / n;
+  if (score <= 0 || score >= 1 || var <= 0)
+    return (0);
+  *elo = -400 * log10 (1 / score - 1);
+  slope = 400 / log (10) / (score * (1 - score));	/* d elo / d score */
+  *margin = 1.96 * sqrt (var / n) * slope;
+  s0 = 1 / (1 + pow (10, -m->elo0 / 400));
+  s1 = 1 / (1 + pow (10, -m->elo1 / 400));
+  return (n * (s1 - s0) * (2 * score - s0 - s1) / (2 * var));
+}
+
+int
+tune (char *filename, struct options *opt, int epochs, int jobs)
+/*----------> purpose: fit the evaluation weights, starting from those of
+  ---------->          opt, to the results of the games the positions in
+  ---------->          filename come from (texel's method). a line of the
+  ---------->          file is a position as for setposition and the
+  ---------->          result, 1-0, 0-1 or 1/2 with black first, as match
+  ---------->          -record writes them. the evaluation is linear in
+  ---------->          the weights, so each position is reduced once to
+  ---------->          its fixed part and features; then the scale k of
+  ---------->          the sigmoid is fitted, and epochs steps of adam
+  ---------->          gradient descent on jobs threads minimize the mean
+  ---------->          squared error. brv only scales the back rank table,
+  ---------->          it is kept and the table is fitted. the weights go
+  ---------->          to stdout in the format of loadweights.
+  ----------> returns 0, or 1 if there are no positions.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct tuneposition *pos;
+  double w[NWEIGHTS], gradient[NWEIGHTS], m[NWEIGHTS] = {0}, v[NWEIGHTS] = {0};
+  double lo = log (1e-4), hi = log (1e-1), a, b, ea, eb, k, before, error, start;
+  int weights[NWEIGHTS];
+  int i, epoch;
+  long n;
+
+  if (jobs <= 0)
+    jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  start = walltime ();
+  if ((n = loadtunepositions (filename, &pos, opt->weights, jobs)) == 0)
+    return (1);
+  fprintf (stderr, "%li positions, features in %.1f s\n", n, walltime () - start);
+  for (i = 0; i < NWEIGHTS; i++)
+    w[i] = opt->weights[i];
+
+/*----------> the k that fits the starting weights best, golden section */
+  a = hi - 0.618 * (hi - lo);
+  b = lo + 0.618 * (hi - lo);
+  ea = tuneerror (pos, n, w, exp (a), NULL, jobs);
+  eb = tuneerror (pos, n, w, exp (b), NULL, jobs);
+  while (hi - lo > 1e-3)
+    if (ea < eb)
+      {
+	hi = b, b = a, eb = ea;
+	a = hi - 0.618 * (hi - lo);
+	ea = tuneerror (pos, n, w, exp (a), NULL, jobs);
+      }
+    else
+      {
+	lo = a, a = b, ea = eb;
+	b = lo + 0.618 * (hi - lo);
+	eb = tuneerror (pos, n, w, exp (b), NULL, jobs);
+      }
+  k = exp ((lo + hi) / 2);
+  before = tuneerror (pos, n, w, k, NULL, jobs);
+  fprintf (stderr, "k %.5f, error %.6f\n", k, before);
+
+/*----------> adam */
+  start = walltime ();
+  for (epoch = 1; epoch <= epochs; epoch++)
+    {
+      error = tuneerror (pos, n, w, k, gradient, jobs);
+      for (i = 0; i < NWEIGHTS; i++)
+	{
+	  if (i == EVBRV)
+	    continue;
+	  m[i] = 0.9 * m[i] + 0.1 * gradient[i];
+	  v[i] = 0.999 * v[i] + 0.001 * gradient[i] * gradient[i];
+	  w[i] -= TUNERATE * (m[i] / (1 - pow (0.9, epoch)))
+	    / (sqrt (v[i] / (1 - pow (0.999, epoch))) + 1e-12);
+	}
+      if (epoch % 100 == 0 || epoch == epochs)
+	fprintf (stderr, "epoch %i: error %.6f, %.3f s per epoch\n", epoch, error,
+		 (walltime () - start) / epoch);
+    }
+
+  for (i = 0; i < NWEIGHTS; i++)
+    {
+      weights[i] = (int) floor (w[i] + 0.5);
+      w[i] = weights[i];
+    }
+  error = tuneerror (pos, n, w, k, NULL, jobs);
+  printf ("# tuned on %li positions of %s, k %.5f, error %.6f, was %.6f\n",
+	  n, filename, k, error, before);
+  printweights (stdout, weights);
+  free (pos);
+  return (0);
+}
+
+long
+loadtunepositions (char *filename, struct tuneposition **pos, int weights[NWEIGHTS], int jobs)
+/*----------> purpose: read the positions and results of filename for tune
+  ---------->          and reduce them to their features on jobs threads.
+  ---------->          positions with a capture to make or no move at all
+  ---------->          have no static value and are left out.
+  ----------> returns the number of positions in *pos, 0 if there are none
+  ---------->          or memory runs out. */
+{
+  FILE *fp;
+  char line[256], squares[33], side[2], result[8];
+  char (*lines)[40] = NULL, (*morelines)[40];
+  struct tuneposition *p = NULL, *more;
+  struct tunejob *job;
+  pthread_t *thread;
+  long n = 0, size = 0, chunk, i, j, bad = 0;
+  int started;
+
+  if ((fp = fopen (filename, "r")) == NULL)
+    {
+      perror (filename);
+      return (0);
+    }
+  while (fgets (line, sizeof (line), fp))
+    {
+      if (line[0] == '#' || sscanf (line, "%32s %1s %7s", squares, side, result) != 3)
+	continue;
+      if (n == size)
+	{
+	  size = size ? 2 * size : 65536;
+	  if ((morelines = realloc (lines, size * sizeof (*lines))) != NULL)
+	    lines = morelines;
+	  if ((more = realloc (p, size * sizeof (*p))) != NULL)
+	    p = more;
+	  if (morelines == NULL || more == NULL)
+	    {
+	      fprintf (stderr, "simplech: out of memory\n");
+	      fclose (fp);
+	      free (lines);
+	      free (p);
+	      return (0);
+	    }
+	}
+      snprintf (lines[n], sizeof (lines[n]), "%s %s", squares, side);
+      p[n].result = !strcmp (result, "1-0") ? 1 : !strcmp (result, "0-1") ? 0 : 0.5;
+      n++;
+    }
+  fclose (fp);
+  if (n == 0)
+    {
+      fprintf (stderr, "simplech: no positions in %s\n", filename);
+      free (lines);
+      free (p);
+      return (0);
+    }
+
+  job = calloc (jobs, sizeof (struct tunejob));
+  thread = malloc (jobs * sizeof (pthread_t));
+  if (job == NULL || thread == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      free (job);
+      free (thread);
+      free (lines);
+      free (p);
+      return (0);
+    }
+  chunk = (n + jobs - 1) / jobs;
+  for (i = 0; i < jobs; i++)
+    {
+      job[i].pos = p + i * chunk;
+      job[i].lines = lines + i * chunk;
+      job[i].n = (i * chunk >= n) ? 0 : (n - i * chunk < chunk) ? n - i * chunk : chunk;
+      job[i].base = weights;
+    }
+/*----------> jobs whose thread cannot be started are run here */
+  for (started = 0; started < jobs; started++)
+    if (pthread_create (&thread[started], NULL, tuneextract, &job[started]))
+      break;
+  for (i = started; i < jobs; i++)
+    tuneextract (&job[i]);
+  for (i = 0; i < jobs; i++)
+    {
+      if (i < started)
+	pthread_join (thread[i], NULL);
+      bad += job[i].bad;
+    }
+  if (bad)
+    fprintf (stderr, "simplech: %li positions cannot be evaluated linearly\n", bad);
+
+/*----------> squeeze out the positions without a static value */
+  for (i = j = 0; i < n; i++)
+    if (p[i].result >= 0)
+      p[j++] = p[i];
+  free (lines);
+  free (job);
+  free (thread);
+  *pos = p;
+  return (j);
+}
+
+void *
+tuneextract (void *arg)
+/*----------> purpose: reduce the positions of a tunejob to the fixed part of
+  ---------->          their evaluation and the features of the tuned
+  ---------->          weights: the evaluation changes by feature[i] when
+  ---------->          weight i grows by one. marks those without a static
+  ---------->          value with result -1. */
+{
+  struct tunejob *job = arg;
+  struct tuneposition *p;
+  struct move2 movelist[MAXMOVES];
+  int zero[NWEIGHTS];
+  int b[46];
+  int i, color, value;
+  long l;
+
+  for (i = 0; i < NWEIGHTS; i++)
+    zero[i] = (i == EVBRV) ? job->base[i] : 0;
+  for (l = 0; l < job->n; l++)
+    {
+      p = &job->pos[l];
+      color = setposition (b, job->lines[l]);
+      if (color == 0 || testcapture (b, color) || generatemovelist (b, movelist, color) == 0)
+	{
+	  p->result = -1;
+	  continue;
+	}
+      p->fixed = evaluation (b, color, zero);
+      value = p->fixed;
+      for (i = 0; i < NWEIGHTS; i++)
+	{
+	  p->feature[i] = 0;
+	  if (i == EVBRV)
+	    continue;
+	  zero[i] = 1;
+	  p->feature[i] = evaluation (b, color, zero) - p->fixed;
+	  zero[i] = 0;
+	  value += job->base[i] * p->feature[i];
+	}
+      if (value != evaluation (b, color, job->base))
+	{
+	  p->result = -1;
+	  job->bad++;
+	}
+    }
+  return (NULL);
+}
+
+double
+tuneerror (struct tuneposition *pos, long n, double weights[NWEIGHTS], double k, double gradient[NWEIGHTS], int jobs)
+/*----------> purpose: the mean squared error of the positions pos with
+  ---------->          weights, on jobs threads, and its gradient if
+  ---------->          gradient is not NULL. */
+{
+  struct tunejob job[MAXTHREADS];
+  pthread_t thread[MAXTHREADS];
+  double error = 0;
+  long chunk;
+  int i, j, started;
+
+  if (jobs > MAXTHREADS)
+    jobs = MAXTHREADS;
+  chunk = (n + jobs - 1) / jobs;
+  for (i = 0; i < jobs; i++)
+    {
+      memset (&job[i], 0, sizeof (job[i]));
+      job[i].pos = pos + i * chunk;
+      job[i].n = (i * chunk >= n) ? 0 : (n - i * chunk < chunk) ? n - i * chunk : chunk;
+      job[i].weights = weights;
+      job[i].k = k;
+      job[i].wantgradient = (gradient != NULL);
+    }
+/*----------> job 0 and those whose thread cannot be started run here */
+  for (started = 1; started < jobs; started++)
+    if (pthread_create (&thread[started], NULL, tuneworker, &job[started]))
+      break;
+  tuneworker (&job[0]);
+  for (i = started; i < jobs; i++)
+    tuneworker (&job[i]);
+  for (j = 0; gradient && j < NWEIGHTS; j++)
+    gradient[j] = 0;
+  for (i = 0; i < jobs; i++)
+    {
+      if (i > 0 && i < started)
+	pthread_join (thread[i], NULL);
+      error += job[i].error;
+      for (j = 0; gradient && j < NWEIGHTS; j++)
+	gradient[j] += job[i].gradient[j] / n;
+    }
+  return (error / n);
+}
+
+void *
+tuneworker (void *arg)
+/*----------> purpose: sum the squared errors of a tunejob and their
+  ---------->          gradient. */
+{
+  struct tunejob *job = arg;
+  struct tuneposition *p;
+  double eval, sigmoid, g;
+  long l;
+  int i;
+
+  for (l = 0; l < job->n; l++)
+    {
+      p = &job->pos[l];
+      eval = p->fixed;
+      for (i = 0; i < NWEIGHTS; i++)
+	eval += job->weights[i] * p->feature[i];
+      sigmoid = 1 / (1 + exp (-job->k * eval));
+      job->error += (sigmoid - p->result) * (sigmoid - p->result);
+      if (job->wantgradient)
+	{
+	  g = 2 * (sigmoid - p->result) * sigmoid * (1 - sigmoid) * job->k;
+	  for (i = 0; i < NWEIGHTS; i++)
+	    job->gradient[i] += g * p->feature[i];
+	}
+    }
+  return (NULL);
+}
+
+long
+pdnread (char *filename, int check, int (*callback) (struct pdngame *g, void *arg), void *arg)
+/*----------> purpose: read the games of the pdn file filename and hand each
+  ---------->          to callback, until it returns nonzero. the file is
+  ---------->          mapped, not copied: the tags of a game point into it
+  ---------->          and are valid during the callback only. the moves are
+  ---------->          played on the board as they are read; a game with a
+  ---------->          move that is not legal, or with more than PDNPLIES
+  ---------->          moves, has its error set and the moves before it.
+  ---------->          without check, a quiet move is not tested against
+  ---------->          the capture it may have had to make instead, which
+  ---------->          more than doubles the speed for trusted files.
+  ----------> returns the number of games read, -1 if the file cannot be
+  ---------->          mapped or memory runs out.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  struct pdngame *g;
+  struct pdntag *tag;
+  struct stat st;
+  char fen[FENLENGTH];
+  const char *map, *p, *end;
+  long games = 0, line = 1;
+  int fd;
+
+  if ((fd = open (filename, O_RDONLY)) < 0 || fstat (fd, &st) < 0)
+    {
+      perror (filename);
+      if (fd >= 0)
+	close (fd);
+      return (-1);
+    }
+  if (st.st_size == 0)
+    {
+      close (fd);
+      return (0);
+    }
+  map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      perror (filename);
+      return (-1);
+    }
+  madvise ((void *) map, st.st_size, MADV_SEQUENTIAL);
+  if ((g = malloc (sizeof (struct pdngame))) == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      munmap ((void *) map, st.st_size);
+      return (-1);
+    }
+
+  p = map;
+  end = map + st.st_size;
+  while (p < end)
+    {
+      for (; p < end && isspace ((unsigned char) *p); p++)
+	if (*p == '\n')
+	  line++;
+      if (p == end)
+	break;
+      g->tags = 0;
+      g->plies = 0;
+      g->result = PDNUNKNOWN;
+      g->error = NULL;
+      g->line = line;
+      g->check = check;
+      initcheckers (g->b);
+      g->color = BLACK;
+
+/*----------> the tags, [name "value"] */
+      while (p < end && *p == '[')
+	{
+	  tag = &g->tag[g->tags < PDNTAGS ? g->tags : PDNTAGS - 1];
+	  for (tag->name = ++p; p < end && !isspace ((unsigned char) *p) && *p != '"' && *p != ']'; p++)
+	    ;
+	  tag->namelength = p - tag->name;
+	  for (; p < end && *p != '"' && *p != ']' && *p != '\n'; p++)
+	    ;
+	  tag->value = p;
+	  tag->valuelength = 0;
+	  if (p < end && *p == '"')
+	    {
+	      for (tag->value = ++p; p < end && *p != '"' && *p != '\n'; p++)
+		if (*p == '\\' && p + 1 < end)
+		  p++;
+	      tag->valuelength = p - tag->value;
+	    }
+	  for (; p < end && *p != ']' && *p != '\n'; p++)
+	    ;
+	  if (p < end && *p == ']')
+	    p++;
+	  if (g->tags < PDNTAGS)
+	    g->tags++;
+	  if (tag->namelength == 3 && !memcmp (tag->name, "FEN", 3))
+	    {
+	      snprintf (fen, sizeof (fen), "%.*s", tag->valuelength, tag->value);
+	      if ((g->color = setfen (g->b, fen)) == 0)
+		g->error = "bad FEN tag";
+	    }
+	  for (; p < end && isspace ((unsigned char) *p); p++)
+	    if (*p == '\n')
+	      line++;
+	}
+
+      p = pdnmovetext (g, p, end, &line);
+      games++;
+      if (callback (g, arg))
+	break;
+    }
+  free (g);
+  munmap ((void *) map, st.st_size);
+  return (games);
+}
+
+const char *
+pdnmovetext (struct pdngame *g, const char *p, const char *end, long *line)
+/*----------> purpose: read the moves of g from p on and play them from its
+  ---------->          start position, skipping move numbers, comments,
+  ---------->          variations and annotations, up to its result or the
+  ---------->          tags of the next game.
+  ----------> returns where reading stopped. */
+{
+  static const char *results[] = {"1-0", "0-1", "1/2-1/2", "2-0", "0-2", "1-1"};
+  static const int resultvalue[] = {1, -1, 0, 1, -1, 0};
+  int b[46], squares[12];
+  int i, n, len, depth, color = g->color;
+
+  memcpy (b, g->b, sizeof (b));
+  while (p < end)
+    switch (*p)
+      {
+      case '\n':
+	(*line)++;
+	/* fall through */
+      case ' ':
+      case '\t':
+      case '\r':
+	p++;
+	break;
+      case '[':
+	return (p);
+      case '*':
+	return (p + 1);
+      case '{':
+	for (; p < end && *p != '}'; p++)
+	  if (*p == '\n')
+	    (*line)++;
+	if (p < end)
+	  p++;
+	break;
+      case ';':
+	for (; p < end && *p != '\n'; p++)
+	  ;
+	break;
+      case '(':
+	for (depth = 0; p < end; p++)
+	  {
+	    if (*p == '\n')
+	      (*line)++;
+	    else if (*p == '(')
+	      depth++;
+	    else if (*p == ')' && --depth == 0)
+	      break;
+	  }
+	if (p < end)
+	  p++;
+	break;
+      case '$':
+	for (; p < end && !isspace ((unsigned char) *p); p++)
+	  ;
+	break;
+      default:
+	if (!isdigit ((unsigned char) *p))
+	  {
+	    p++;		/* !, ? and the like */
+	    break;
+	  }
+/*----------> a result ends the game */
+	for (i = (p + 1 < end && (p[1] == '-' || p[1] == '/')) ? 0 : 6; i < 6; i++)
+	  {
+	    len = strlen (results[i]);
+	    if (end - p >= len && !memcmp (p, results[i], len)
+		&& (p + len == end || isspace ((unsigned char) p[len])))
+	      {
+		g->result = resultvalue[i];
+		return (p + len);
+	      }
+	  }
+/*----------> a move number or a move, squares joined by - or x */
+	for (n = 0; p < end && isdigit ((unsigned char) *p);)
+	  {
+	    for (i = 0; p < end && isdigit ((unsigned char) *p); p++)
+	      i = 10 * i + *p - '0';
+	    if (n < 12)
+	      squares[n++] = i;
+	    if (p + 1 < end && (*p == '-' || *p == 'x') && isdigit ((unsigned char) p[1]))
+	      p++;
+	  }
+	if (n == 1)
+	  {
+	    for (; p < end && *p == '.'; p++)
+	      ;
+	    break;
+	  }
+	if (g->error)
+	  break;
+	if (g->plies == PDNPLIES)
+	  g->error = "too many moves";
+	else if (!pdnmove (g, b, color, squares, n))
+	  g->error = "illegal move";
+	else
+	  color ^= CHANGECOLOR;
+      }
+  return (p);
+}
+
+int
+pdnmove (struct pdngame *g, int b[46], int color, int squares[], int n)
+/*----------> purpose: find the move of color on b from squares[0] to
+  ---------->          squares[n-1], over the landing squares in between if
+  ---------->          they are given, play it and add it to g.
+  ----------> returns 0 if there is no such move. */
+{
+  struct move2 movelist[MAXMOVES];
+  int i, j, k, square, from, to, piece;
+
+  for (i = 0; i < n; i++)
+    if (squares[i] < 1 || squares[i] > 32)
+      return (0);
+  from = squareindex (squares[0]);
+  to = squareindex (squares[n - 1]);
+  if (n == 2 && (to - from == 4 || to - from == 5 || from - to == 4 || from - to == 5)
+      && (!g->check || !testcapture (b, color)))
+    {
+/*----------> a quiet move is checked without generating the list, encoded
+  ---------->          as generatemovelist does */
+      piece = b[from];
+      if (!(piece & color) || b[to] != FREE)
+	return (0);
+      if (!(((to - from == 4 || to - from == 5) && (piece & KING || color == BLACK))
+	    || ((from - to == 4 || from - to == 5) && (piece & KING || color == WHITE))))
+	return (0);
+      movelist[0].n = 2;
+      movelist[0].m[0] = from | piece << 8 | FREE << 16;
+      if ((piece & MAN) && (to >= 37 || to <= 8))
+	piece = color | KING;
+      movelist[0].m[1] = to | FREE << 8 | piece << 16;
+      g->move[g->plies++] = movelist[0];
+      domove (b, movelist[0]);
+      return (1);
+    }
+  k = generatecapturelist (b, movelist, color);
+  for (i = 0; i < k; i++)
+    {
+      if (squarenumber (movelist[i].m[0] % 256) != squares[0]
+	  || squarenumber (movelist[i].m[1] % 256) != squares[n - 1])
+	continue;
+      if (n > 2)
+	{
+	  /* the captured pieces are in the order taken, see cbmove */
+	  if (movelist[i].n != n + 1)
+	    continue;
+	  square = movelist[i].m[0] % 256;
+	  for (j = 2; j < movelist[i].n; j++)
+	    {
+	      square = 2 * (movelist[i].m[j] % 256) - square;
+	      if (squarenumber (square) != squares[j - 1])
+		break;
+	    }
+	  if (j < movelist[i].n)
+	    continue;
+	}
+      g->move[g->plies++] = movelist[i];
+      domove (b, movelist[i]);
+      return (1);
+    }
+  return (0);
+}
+
+struct pdnwriter *
+pdnopen (char *filename)
+/*----------> purpose: open filename for pdnwrite, with a buffer of
+  ---------->          PDNBUFFER bytes.
+  ----------> returns NULL if it cannot be created. */
+{
+  struct pdnwriter *w;
+
+  if ((w = malloc (sizeof (struct pdnwriter))) == NULL)
+    return (NULL);
+  if ((w->fp = fopen (filename, "w")) == NULL)
+    {
+      perror (filename);
+      free (w);
+      return (NULL);
+    }
+  w->buffer = malloc (PDNBUFFER);
+  setvbuf (w->fp, w->buffer, _IOFBF, PDNBUFFER);
+  return (w);
+}
+
+void
+pdnwrite (struct pdnwriter *w, struct pdngame *g)
+/*----------> purpose: write game g in pdn: its tags, a Result tag if it
+  ---------->          has none, a FEN tag if it has none and does not
+  ---------->          start from the initial position, and the moves,
+  ---------->          captures with all the squares landed on, in lines of
+  ---------->          at most 80 characters. */
+{
+  static const char *results[] = {"0-1", "1/2-1/2", "1-0", "*"};
+  char str[FENLENGTH];
+  int b[46];
+  int i, j, len, column = 0, square, result = 0, fen = 0, number = 1;
+
+  for (i = 0; i < g->tags; i++)
+    {
+      fprintf (w->fp, "[%.*s \"%.*s\"]\n", g->tag[i].namelength, g->tag[i].name,
+	       g->tag[i].valuelength, g->tag[i].value);
+      if (g->tag[i].namelength == 6 && !memcmp (g->tag[i].name, "Result", 6))
+	result = 1;
+      if (g->tag[i].namelength == 3 && !memcmp (g->tag[i].name, "FEN", 3))
+	fen = 1;
+    }
+  if (!result)
+    fprintf (w->fp, "[Result \"%s\"]\n", results[g->result + 1]);
+  initcheckers (b);
+  if (!fen && (g->color != BLACK || memcmp (b, g->b, sizeof (b))))
+    {
+      fenstring (g->b, g->color, str);
+      fprintf (w->fp, "[FEN \"%s\"]\n", str);
+    }
+
+  for (i = 0; i <= g->plies; i++)
+    {
+      len = 0;
+      if (i < g->plies && (g->color == BLACK) == (i % 2 == 0))
+	len = sprintf (str, "%i. ", number++);
+      else if (i == 0 && g->plies > 0)
+	len = sprintf (str, "%i... ", number++);
+      if (i == g->plies)
+	len += sprintf (str + len, "%s", results[g->result + 1]);
+      else if (g->move[i].n == 2)
+	len += sprintf (str + len, "%i-%i", squarenumber (g->move[i].m[0] % 256),
+			squarenumber (g->move[i].m[1] % 256));
+      else
+	{
+	  square = g->move[i].m[0] % 256;
+	  len += sprintf (str + len, "%i", squarenumber (square));
+	  for (j = 2; j < g->move[i].n; j++)
+	    {
+	      square = 2 * (g->move[i].m[j] % 256) - square;
+	      len += sprintf (str + len, "x%i", squarenumber (square));
+	    }
+	}
+      if (column + len >= 80)
+	{
+	  fputc ('\n', w->fp);
+	  column = 0;
+	}
+      column += fprintf (w->fp, column ? " %s" : "%s", str);
+    }
+  fputs ("\n\n", w->fp);
+}
+
+int
+pdnclose (struct pdnwriter *w)
+/*----------> purpose: flush and close a pdn file opened by pdnopen.
+  ----------> returns 0, or EOF if writing failed. */
+{
+  int r = fclose (w->fp);
+
+  free (w->buffer);
+  free (w);
+  return (r);
+}
+
+int
+pdncommand (char *filename, char *out, int check)
+/*----------> purpose: read and check the games of filename, report the
+  ---------->          invalid ones and the throughput, and copy the valid
+  ---------->          ones to out if it is not NULL. check as for pdnread.
+  ----------> returns 0, 1 if a file cannot be read or written. */
+{
+  struct pdnsummary sum = {filename, 0, 0, 0, NULL};
+  struct stat st;
+  double start, time;
+  long games;
+
+  if (out && (sum.out = pdnopen (out)) == NULL)
+    return (1);
+  start = walltime ();
+  games = pdnread (filename, check, pdnsummarize, &sum);
+  time = walltime () - start;
+  if (sum.out && pdnclose (sum.out))
+    {
+      perror (out);
+      return (1);
+    }
+  if (games < 0 || stat (filename, &st) < 0)
+    return (1);
+  fprintf (stderr, "%li games, %li invalid, %li plies, %.1f MB in %.3f s, %.1f MB/s, %.0f games/s\n",
+	   games, sum.invalid, sum.plies, st.st_size / 1e6, time,
+	   st.st_size / 1e6 / time, games / time);
+  return (0);
+}
+
+int
+pdnsummarize (struct pdngame *g, void *arg)
+/*----------> purpose: the pdnread callback of pdncommand. */
+{
+  struct pdnsummary *sum = arg;
+
+  sum->games++;
+  sum->plies += g->plies;
+  if (g->error)
+    {
+      sum->invalid++;
+      fprintf (stderr, "%s:%li: game %li, ply %i: %s\n", sum->filename, g->line,
+	       sum->games, g->plies + 1, g->error);
+    }
+  else if (sum->out)
+    pdnwrite (sum->out, g);
+  return (0);
+}
+
+int
+server (char *path, struct options *opt, int jobs, int maxsessions, int maxsearches)
+/*----------> purpose: serve games on the unix domain socket path. every
+  ---------->          connection is a session which speaks the protocol
+  ---------->          of the protocol command, with an engine of its own;
+  ---------->          with opt->hashshm, all engines share one hashtable.
+  ---------->          commands are read by this thread and run on a pool
+  ---------->          of jobs workers, one command of a session at a
+  ---------->          time, a go with its whole search. the commands the
+  ---------->          protocol answers during a search, stop, ponderhit
+  ---------->          and isready, are answered here at once. a
+  ---------->          connection beyond maxsessions, and a go while
+  ---------->          maxsearches are waiting or running, is refused
+  ---------->          with "error busy". the command latency answers with
+  ---------->          the latency percentiles of the session's searches,
+  ---------->          from go to bestmove; they are also written to
+  ---------->          stderr when the session ends. the connections do
+  ---------->          not block: the answers of a session are kept until
+  ---------->          this thread can write them, see reply. runs until
+  ---------->          SIGINT or SIGTERM.
+  ----------> returns 0, or 1 if the socket or the signals cannot be opened.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  struct server sv;
+  struct sockaddr_un address;
+  struct stat st;
+  struct pollfd *fds;
+  struct session **slot, *s;
+  pthread_t *thread;
+  sigset_t signals;
+  char buffer[1024], *line, *end;
+  int listener, sigfd, fd;
+  int i, n, k, workers;
+
+  if (jobs <= 0)
+    jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  if (maxsessions <= 0)
+    maxsessions = SESSIONS;
+  if (maxsearches <= 0)
+    maxsearches = 4 * jobs;
+  memset (&address, 0, sizeof (address));
+  address.sun_family = AF_UNIX;
+  if (strlen (path) >= sizeof (address.sun_path))
+    {
+      fprintf (stderr, "simplech: %s: path too long\n", path);
+      return (1);
+    }
+  strcpy (address.sun_path, path);
+  /* a socket left by an earlier server is replaced, nothing else */
+  if (stat (path, &st) == 0 && S_ISSOCK (st.st_mode))
+    unlink (path);
+  if ((listener = socket (AF_UNIX, SOCK_STREAM, 0)) < 0
+      || bind (listener, (struct sockaddr *) &address, sizeof (address)) < 0
+      || listen (listener, maxsessions) < 0)
+    {
+      perror (path);
+      return (1);
+    }
+/*----------> the signals are read from a file descriptor in the poll loop,
+  ----------> the workers inherit the mask */
+  sigemptyset (&signals);
+  sigaddset (&signals, SIGINT);
+  sigaddset (&signals, SIGTERM);
+  pthread_sigmask (SIG_BLOCK, &signals, NULL);
+  if ((sigfd = signalfd (-1, &signals, 0)) < 0)
+    {
+      perror ("signalfd");
+      pthread_sigmask (SIG_UNBLOCK, &signals, NULL);
+      close (listener);
+      unlink (path);
+      return (1);
+    }
+  signal (SIGPIPE, SIG_IGN);
+
+  memset (&sv, 0, sizeof (sv));
+  if (pipe (sv.wake) < 0)
+    {
+      perror ("pipe");
+      close (sigfd);
+      close (listener);
+      unlink (path);
+      return (1);
+    }
+  fcntl (sv.wake[0], F_SETFL, O_NONBLOCK);
+  fcntl (sv.wake[1], F_SETFL, O_NONBLOCK);
+  sv.opt = *opt;
+  sv.maxsessions = maxsessions;
+  sv.maxsearches = maxsearches;
+  sv.session = calloc (maxsessions, sizeof (struct session *));
+  fds = malloc ((maxsessions + 3) * sizeof (struct pollfd));
+  slot = malloc ((maxsessions + 3) * sizeof (struct session *));
+  thread = malloc (jobs * sizeof (pthread_t));
+  if (sv.session == NULL || fds == NULL || slot == NULL || thread == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      return (1);
+    }
+  pthread_mutex_init (&sv.lock, NULL);
+  pthread_cond_init (&sv.work, NULL);
+  for (workers = 0; workers < jobs; workers++)
+    if (pthread_create (&thread[workers], NULL, serverworker, &sv))
+      break;
+  fprintf (stderr, "simplech: serving %s, %i workers, %i sessions, %i searches\n",
+	   path, workers, maxsessions, maxsearches);
+
+  while (1)
+    {
+/*----------> sessions which have ended, are idle and have written their
+  ----------> answers are freed; the others are polled for input, and for
+  ----------> output while they have answers waiting */
+      for (n = 3, i = 0; i < maxsessions; i++)
+	if ((s = sv.session[i]) != NULL)
+	  {
+	    pthread_mutex_lock (&s->p.out);
+	    k = s->p.broken;
+	    fds[n].events = (s->p.outputlength && !s->p.broken) ? POLLOUT : 0;
+	    pthread_mutex_unlock (&s->p.out);
+	    /* a client which does not read its answers is let go */
+	    if (k)
+	      endsession (&sv, s);
+	    pthread_mutex_lock (&s->lock);
+	    k = s->closing && !s->scheduled;
+	    if (!s->closing)
+	      fds[n].events |= POLLIN;
+	    pthread_mutex_unlock (&s->lock);
+	    if (k && !(fds[n].events & POLLOUT))
+	      {
+		closesession (s);
+		sv.session[i] = NULL;
+	      }
+	    else if (fds[n].events)
+	      {
+		fds[n].fd = s->fd;
+		slot[n++] = s;
+	      }
+	  }
+      fds[0].fd = listener;
+      fds[1].fd = sigfd;
+      fds[2].fd = sv.wake[0];
+      for (i = 0; i < 3; i++)
+	fds[i].events = POLLIN;
+      /* a session that ended is looked at again soon */
+      if (poll (fds, n, 100) <= 0)
+	continue;
+      if (fds[1].revents)
+	break;
+      if (fds[2].revents)
+	while (read (sv.wake[0], buffer, sizeof (buffer)) > 0)
+	  ;
+
+      if (fds[0].revents & POLLIN && (fd = accept (listener, NULL, NULL)) >= 0)
+	{
+	  for (i = 0; i < maxsessions && sv.session[i]; i++)
+	    ;
+	  if (i == maxsessions || (sv.session[i] = opensession (&sv, fd)) == NULL)
+	    {
+	      k = send (fd, "error busy\n", 11, MSG_DONTWAIT | MSG_NOSIGNAL);
+	      close (fd);
+	      sv.refused++;
+	    }
+	  else
+	    sv.accepted++;
+	}
+
+/*----------> output of the sessions, and input split into lines */
+      for (i = 3; i < n; i++)
+	{
+	  if (!fds[i].revents)
+	    continue;
+	  s = slot[i];
+	  if ((fds[i].events & POLLOUT) && sessionwrite (s) < 0)
+	    {
+	      endsession (&sv, s);
+	      continue;
+	    }
+	  if (!(fds[i].events & POLLIN) || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+	    continue;
+	  k = read (s->fd, buffer, sizeof (buffer));
+	  if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	    continue;
+	  if (k <= 0)
+	    {
+	      /* end of input: the search is stopped, the rest dropped */
+	      endsession (&sv, s);
+	      continue;
+	    }
+	  for (line = buffer; line < buffer + k; line = end + 1)
+	    {
+	      if ((end = memchr (line, '\n', buffer + k - line)) == NULL)
+		end = buffer + k;
+	      if (s->discard)
+		{
+		  /* up to the newline, which ends the discarding */
+		  s->discard = (end == buffer + k);
+		  continue;
+		}
+	      if (s->inputlength + (end - line) >= (long) sizeof (s->input))
+		{
+		  reply (&s->p, "error line too long");
+		  s->inputlength = 0;
+		  s->discard = (end == buffer + k);
+		  continue;
+		}
+	      memcpy (s->input + s->inputlength, line, end - line);
+	      s->inputlength += end - line;
+	      if (end == buffer + k)
+		break;
+	      s->input[s->inputlength] = '\0';
+	      s->inputlength = 0;
+	      sessioninput (&sv, s, s->input);
+	    }
+	}
+    }
+
+/*----------> stop: the searches end, the workers run out of commands */
+  for (i = 0; i < maxsessions; i++)
+    if (sv.session[i])
+      endsession (&sv, sv.session[i]);
+  pthread_mutex_lock (&sv.lock);
+  sv.stop = 1;
+  pthread_cond_broadcast (&sv.work);
+  pthread_mutex_unlock (&sv.lock);
+  for (i = 0; i < workers; i++)
+    pthread_join (thread[i], NULL);
+  for (i = 0; i < maxsessions; i++)
+    if (sv.session[i])
+      closesession (sv.session[i]);
+  fprintf (stderr, "simplech: %li sessions, %li refused\n", sv.accepted, sv.refused);
+  close (listener);
+  close (sigfd);
+  close (sv.wake[0]);
+  close (sv.wake[1]);
+  unlink (path);
+  pthread_mutex_destroy (&sv.lock);
+  pthread_cond_destroy (&sv.work);
+  free (sv.session);
+  free (fds);
+  free (slot);
+  free (thread);
+  return (0);
+}
+
+struct session *
+opensession (struct server *sv, int fd)
+/*----------> purpose: start a session on the connection fd, with an engine
+  ---------->          of the server's options on the start position.
+  ----------> returns the session, or NULL if out of memory. */
+{
+  struct session *s;
+
+  if ((s = calloc (1, sizeof (struct session))) == NULL)
+    return (NULL);
+  if (!copyoptions (&s->p.opt, &sv->opt) || (s->p.e = newengine (&s->p.opt)) == NULL)
+    {
+      freeoptions (&s->p.opt);
+      free (s);
+      return (NULL);
+    }
+  fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+  s->p.served = 1;
+  s->p.wake = sv->wake[1];
+  pthread_mutex_init (&s->p.out, NULL);
+  initcheckers (s->p.b);
+  s->p.color = BLACK;
+  gamestart (s->p.e, s->p.b, s->p.color);
+  s->fd = fd;
+  s->id = sv->accepted + 1;
+  pthread_mutex_init (&s->lock, NULL);
+  return (s);
+}
+
+void
+closesession (struct session *s)
+/*----------> purpose: free the idle session s, closing its connection, and
+  ---------->          write its latencies to stderr. answers the connection
+  ---------->          does not take at once are lost. */
+{
+  char str[160];
+
+  sessionlatency (s, str);
+  fprintf (stderr, "session %i: %s\n", s->id, str);
+  sessionwrite (s);
+  close (s->fd);
+  free (s->p.output);
+  freeengine (s->p.e);
+  freeoptions (&s->p.opt);
+  pthread_mutex_destroy (&s->p.out);
+  pthread_mutex_destroy (&s->lock);
+  free (s);
+}
+
+void
+endsession (struct server *sv, struct session *s)
+/*----------> purpose: the connection of s has ended or the server stops:
+  ---------->          stop its search and drop the commands waiting. */
+{
+  pthread_mutex_lock (&s->lock);
+  s->closing = 1;
+  if (s->running)
+    cancelsearch (s->running);
+  droprequests (sv, s);
+  pthread_mutex_unlock (&s->lock);
+}
+
+int
+sessionwrite (struct session *s)
+/*----------> purpose: write as much of the answers of s as its connection
+  ---------->          takes without blocking.
+  ----------> returns 0, or -1 if the connection is broken or s has left
+  ---------->          too much unread; its answers are then dropped. */
+{
+  ssize_t k = 0;
+
+  pthread_mutex_lock (&s->p.out);
+  if (s->p.outputlength && !s->p.broken)
+    k = write (s->fd, s->p.output, s->p.outputlength);
+  if (k > 0)
+    {
+      s->p.outputlength -= k;
+      memmove (s->p.output, s->p.output + k, s->p.outputlength);
+    }
+  else if (k < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+    s->p.broken = 1;
+  if (s->p.broken)
+    s->p.outputlength = 0;
+  k = s->p.broken ? -1 : 0;
+  pthread_mutex_unlock (&s->p.out);
+  return (k);
+}
+
+void
+sessioninput (struct server *sv, struct session *s, char *line)
+/*----------> purpose: a command line of session s was read. while a worker
+  ---------->          searches for s, stop and ponderhit act on the
+  ---------->          search, and isready is answered unless commands
+  ---------->          wait before it or the search was stopped; as in
+  ---------->          the protocol, stop then waits for bestmove.
+  ---------->          anything else waits its turn; a session with
+  ---------->          commands waiting is in the run queue. a go is
+  ---------->          refused while the server has maxsearches. */
+{
+  struct request *r;
+  char command[16];
+
+  if (sscanf (line, "%15s", command) != 1)
+    return;
+  pthread_mutex_lock (&s->lock);
+  if (s->closing)
+    {
+      pthread_mutex_unlock (&s->lock);
+      return;
+    }
+  if (s->running && !strcmp (command, "stop"))
+    {
+      cancelsearch (s->running);
+      s->stopping = 1;
+    }
+  else if (s->running && !strcmp (command, "ponderhit"))
+    {
+      s->p.e->ponderhit = walltime ();
+      s->p.e->pondering = 0;
+    }
+  else if (s->running && !s->stopping && s->head == NULL && !strcmp (command, "isready"))
+    reply (&s->p, "readyok");
+  else if ((r = calloc (1, sizeof (struct request))) == NULL || (r->line = strdup (line)) == NULL)
+    {
+      free (r);
+      reply (&s->p, "error out of memory");
+    }
+  else
+    {
+      r->arrival = walltime ();
+      if (!strcmp (command, "go"))
+	{
+	  pthread_mutex_lock (&sv->lock);
+	  if (sv->searches < sv->maxsearches)
+	    r->search = ++sv->searches;
+	  else
+	    sv->refused++;
+	  pthread_mutex_unlock (&sv->lock);
+	  if (!r->search)
+	    {
+	      reply (&s->p, "error busy");
+	      free (r->line);
+	      free (r);
+	      pthread_mutex_unlock (&s->lock);
+	      return;
+	    }
+	}
+      if (s->tail)
+	s->tail->next = r;
+      else
+	s->head = r;
+      s->tail = r;
+      if (!s->scheduled)
+	schedule (sv, s);
+    }
+  pthread_mutex_unlock (&s->lock);
+}
+
+void
+schedule (struct server *sv, struct session *s)
+/*----------> purpose: append s, with s->lock held, to the run queue */
+{
+  s->scheduled = 1;
+  s->next = NULL;
+  pthread_mutex_lock (&sv->lock);
+  if (sv->tail)
+    sv->tail->next = s;
+  else
+    sv->head = s;
+  sv->tail = s;
+  pthread_cond_signal (&sv->work);
+  pthread_mutex_unlock (&sv->lock);
+}
+
+void *
+serverworker (void *arg)
+/*----------> purpose: a worker of the server: run the next command of the
+  ---------->          first session in the run queue, then put the session
+  ---------->          back at the end if it has more, so that sessions
+  ---------->          take turns. */
+{
+  struct server *sv = arg;
+  struct session *s;
+  struct request *r;
+
+  while (1)
+    {
+      pthread_mutex_lock (&sv->lock);
+      while (sv->head == NULL && !sv->stop)
+	pthread_cond_wait (&sv->work, &sv->lock);
+      if ((s = sv->head) == NULL)
+	{
+	  pthread_mutex_unlock (&sv->lock);
+	  return (NULL);
+	}
+      if ((sv->head = s->next) == NULL)
+	sv->tail = NULL;
+      pthread_mutex_unlock (&sv->lock);
+
+      pthread_mutex_lock (&s->lock);
+      if ((r = s->head) != NULL && (s->head = r->next) == NULL)
+	s->tail = NULL;
+      pthread_mutex_unlock (&s->lock);
+      if (r)
+	sessioncommand (sv, s, r);
+      pthread_mutex_lock (&s->lock);
+      if (s->head)
+	schedule (sv, s);
+      else
+	s->scheduled = 0;
+      pthread_mutex_unlock (&s->lock);
+    }
+}
+
+void
+sessioncommand (struct server *sv, struct session *s, struct request *r)
+/*----------> purpose: run the command r of session s on this worker. a go
+  ---------->          searches here to its end; the stop, ponderhit and
+  ---------->          isready waiting right behind it, up to a stop, are
+  ---------->          taken into the search, later ones go to it
+  ---------->          directly. */
+{
+  struct request *q;
+  char command[16] = "";
+  double latency;
+
+  sscanf (r->line, "%15s", command);
+  if (!strcmp (command, "quit"))
+    {
+      pthread_mutex_lock (&s->lock);
+      s->closing = 1;
+      droprequests (sv, s);
+      pthread_mutex_unlock (&s->lock);
+    }
+  else if (!strcmp (command, "latency"))
+    {
+      char str[160];
+
+      sessionlatency (s, str);
+      reply (&s->p, "latency %s", str);
+    }
+  else
+    protocolcommand (&s->p, r->line);
+
+  if (s->p.search)
+    {
+      pthread_mutex_lock (&s->lock);
+      s->running = s->p.search;
+      while (!s->stopping && (q = s->head) != NULL && sscanf (q->line, "%15s", command) == 1
+	     && (!strcmp (command, "stop") || !strcmp (command, "ponderhit") || !strcmp (command, "isready")))
+	{
+	  if (command[0] == 's')
+	    {
+	      cancelsearch (s->running);
+	      s->stopping = 1;
+	    }
+	  else if (command[0] == 'p')
+	    {
+	      s->p.e->ponderhit = walltime ();
+	      s->p.e->pondering = 0;
+	    }
+	  else
+	    reply (&s->p, "readyok");
+	  if ((s->head = q->next) == NULL)
+	    s->tail = NULL;
+	  free (q->line);
+	  free (q);
+	}
+      pthread_mutex_unlock (&s->lock);
+      runsearch (s->p.search);
+      pthread_mutex_lock (&s->lock);
+      s->running = NULL;
+      s->stopping = 0;
+      pthread_mutex_unlock (&s->lock);
+      waitsearch (s->p.search, NULL);
+      s->p.search = NULL;
+      latency = walltime () - r->arrival;
+      s->latency[s->searches++ % LATENCIES] = latency;
+    }
+  if (r->search)
+    {
+      pthread_mutex_lock (&sv->lock);
+      sv->searches--;
+      pthread_mutex_unlock (&sv->lock);
+    }
+  free (r->line);
+  free (r);
+}
+
+void
+droprequests (struct server *sv, struct session *s)
+/*----------> purpose: forget the commands waiting in s, with s->lock held */
+{
+  struct request *r;
+
+  while ((r = s->head) != NULL)
+    {
+      s->head = r->next;
+      if (r->search)
+	{
+	  pthread_mutex_lock (&sv->lock);
+	  sv->searches--;
+	  pthread_mutex_unlock (&sv->lock);
+	}
+      free (r->line);
+      free (r);
+    }
+  s->tail = NULL;
+}
+
+void
+sessionlatency (struct session *s, char str[160])
+/*----------> purpose: write the number of searches of s and the 50th, 90th
+  ---------->          and 99th percentile and the maximum of the latency of
+  ---------->          the last LATENCIES of them, in milliseconds, to str */
+{
+  double sorted[LATENCIES];
+  int n = (s->searches < LATENCIES) ? s->searches : LATENCIES;
+
+  memcpy (sorted, s->latency, n * sizeof (double));
+  qsort (sorted, n, sizeof (double), comparedoubles);
+  if (n == 0)
+    sprintf (str, "searches 0");
+  else
+    sprintf (str, "searches %li p50 %.1f p90 %.1f p99 %.1f max %.1f", s->searches,
+	     1000 * sorted[(n - 1) / 2], 1000 * sorted[(9 * n - 1) / 10],
+	     1000 * sorted[(99 * n - 1) / 100], 1000 * sorted[n - 1]);
+}
+
+int
+comparedoubles (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+
+  return ((x > y) - (x < y));
+}
+
+void
+startponder (struct ponder *pd, struct engine *e, int b[46], int color)
+/*----------> purpose: think on the opponent's time in the interactive game.
+  ---------->          color is the opponent, to move on b. if the hashtable
+  ---------->          knows the reply the last search expects, the position
+  ---------->          after it is searched, otherwise b itself, that is all
+  ---------->          replies. the search runs until stopponder; the next
+  ---------->          search of e then starts on its hashtable entries, and
+  ---------->          on a ponder hit finds its first iterations there.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct move2 expected;
+
+  pd->e = e;
+  memcpy (pd->b, b, sizeof (pd->b));
+  pd->color = color;
+  if (expectedreply (e, pd->b, color, &expected))
+    {
+      domove (pd->b, expected);
+      pd->color ^= CHANGECOLOR;
+    }
+  pd->stop = 0;
+  pd->out = e->out;
+  e->out = NULL;
+  e->playnow = &pd->stop;
+  if (!(pd->running = !pthread_create (&pd->thread, NULL, pondersearch, pd)))
+    {
+      e->out = pd->out;
+      e->playnow = NULL;
+    }
+}
+
+void
+stopponder (struct ponder *pd)
+{
+  if (!pd->running)
+    return;
+  pd->stop = 1;
+  pthread_join (pd->thread, NULL);
+  pd->running = 0;
+  pd->e->playnow = NULL;
+  pd->e->out = pd->out;
+}
+
+void *
+pondersearch (void *arg)
+{
+  struct ponder *pd = arg;
+  struct limits lim = {0};
+  struct move2 best, movelist[MAXMOVES];
+  int eval, depth;
+
+  if (generatecapturelist (pd->b, movelist, pd->color) == 0
+      && generatemovelist (pd->b, movelist, pd->color) == 0)
+    return (NULL);
+  smpsearch (pd->e, pd->b, pd->color, &lim, &best, &eval, &depth);
+  return (NULL);
+}
+
+void
+jsonstring (FILE *fp, char *str)
+/*----------> purpose: write str to fp as a quoted json string */
+{
+  putc ('"', fp);
+  for (; *str; str++)
+    {
+      if (*str == '"' || *str == '\\')
+	putc ('\\', fp);
+      if ((unsigned char) *str >= ' ')
+	putc (*str, fp);
+    }
+  putc ('"', fp);
+}
+
+void
+usage (void)
+{
+  fprintf (stderr,
+	   "usage: simplech [options]                    play checkers\n"
+	   "       simplech protocol [options]             engine protocol on stdin\n"
+	   "       simplech server socket [-jobs n] [-sessions n] [-queue n] [options]\n"
+	   "                                                  protocol sessions on a socket\n"
+	   "       simplech match [openings] -a \"option value ...\" -b \"...\" [-games n]\n"
+	   "                [-time s] [-depth d] [-nodes n] [-jobs n] [-elo0 e] [-elo1 e]\n"
+	   "                [-alpha a] [-beta b] [-record file] [options]\n"
+	   "                                                  engine a against engine b\n"
+	   "       simplech tune file [-epochs n] [-jobs n] [options]\n"
+	   "                                                  fit the evaluation weights\n"
+	   "       simplech pdn file [-out file] [-check 0|1]  check and copy pdn games\n"
+	   "       simplech pack file -out file             positions to 16 byte records\n"
+	   "       simplech unpack file                     records to fen\n"
+	   "       simplech compact file -out file          compact an analysis store\n"
+	   "       simplech bench [-depth d] [options]     node count signature\n"
+	   "       simplech smpbench [-time s] [options]  smp scaling benchmark\n"
+	   "       simplech batch file [-time s] [-depth d] [-nodes n] [-jobs n] [options]\n"
+	   "       simplech driverbench [-depth d] [options]  alphabeta against mtdf\n"
+	   "       simplech selectbench [-depth d] [options]  savings of selective search\n"
+	   "       simplech probcutfit [file] [-depth d] [options]  fit the probcut model\n"
+	   "       simplech perft [-depth d]               verify the move generator\n"
+	   "       simplech microbench [-format text|json]  time the search kernels\n"
+	   "options: -threads n -hashbits n -driver alphabeta|mtdf -lmr 0|1 -futility 0|1\n"
+	   "         -probcut 0|1 -pcslope a -pcoffset b -pcsigma s -pcthreshold t\n"
+	   "         -stats 0|1 -ponder 0|1 -weights file -<weight> n -store file\n"
+	   "         -hashfile file -hashshm /name -trace file (compiled with TRACE)\n");
+}
+
+void
+microbenchmark (int json)
+/*----------> purpose: time the kernels of the search on the bench positions:
+  ---------->          move and capture generation, testcapture, domove with
+  ---------->          undomove and evaluation. each kernel is warmed up and
+  ---------->          calibrated to MICROTIME per repetition, then timed
+  ---------->          MICROREPS times. reports ns per operation as mean,
+  ---------->          standard deviation and minimum, as a table or as one
+  ---------->          json object per kernel. makeunmake times domove and
+  ---------->          undomove alone, on move lists made beforehand.
+  ----------> version: 2.1
+  ----------> date: 18th october 2026 */
+{
+  static char *name[] =
+  {"movegen", "capturegen", "testcapture", "makeunmake", "evaluation"};
+  int boards[sizeof (benchpositions) / sizeof (char *)][46];
+  int colors[sizeof (benchpositions) / sizeof (char *)];
+  struct move2 moves[sizeof (benchpositions) / sizeof (char *)][MAXMOVES];
+  int counts[sizeof (benchpositions) / sizeof (char *)];
+  int n = sizeof (benchpositions) / sizeof (char *);
+  int i, k, r;
+  long rounds, ops;
+  double start, time, ns[MICROREPS], mean, var, min;
+  volatile int sink;
+
+  for (i = 0; i < n; i++)
+    {
+      colors[i] = setposition (boards[i], benchpositions[i]);
+      /* the moves of makeunmake, generated outside the timing */
+      counts[i] = generatecapturelist (boards[i], moves[i], colors[i]);
+      if (counts[i] == 0)
+	counts[i] = generatemovelist (boards[i], moves[i], colors[i]);
+    }
+  if (!json)
+    printf ("%-12s %10s %8s %8s %8s\n", "kernel", "ops", "ns/op", "stddev", "min");
+  for (k = 0; k < (int) (sizeof (name) / sizeof (char *)); k++)
+    {
+/*----------> warm up and find the rounds for one repetition */
+      for (rounds = 1;; rounds *= 2)
+	{
+	  start = walltime ();
+	  microkernel (k, boards, colors, moves, counts, n, rounds, &sink);
+	  if (walltime () - start >= MICROTIME)
+	    break;
+	}
+      mean = var = 0;
+      min = 1e9;
+      for (r = 0; r < MICROREPS; r++)
+	{
+	  start = walltime ();
+	  ops = microkernel (k, boards, colors, moves, counts, n, rounds, &sink);
+	  time = walltime () - start;
+	  ns[r] = 1e9 * time / ops;
+	  mean += ns[r] / MICROREPS;
+	  if (ns[r] < min)
+	    min = ns[r];
+	}
+      for (r = 0; r < MICROREPS; r++)
+	var += (ns[r] - mean) * (ns[r] - mean) / (MICROREPS - 1);
+      if (json)
+	printf ("{\"kernel\":\"%s\",\"positions\":%i,\"ops\":%li,\"reps\":%i,"
+		"\"ns\":%.3f,\"stddev\":%.3f,\"min\":%.3f}\n",
+		name[k], n, ops, MICROREPS, mean, sqrt (var), min);
+      else
+	printf ("%-12s %10li %8.2f %8.2f %8.2f\n", name[k], ops, mean, sqrt (var), min);
+    }
+}
+
+long
+microkernel (int kernel, int boards[][46], int colors[], struct move2 moves[][MAXMOVES], int counts[], int n, long rounds, volatile int *sink)
+/*----------> purpose: run kernel rounds times over the n boards, with the
+  ---------->          counts[i] legal moves of board i in moves[i]. the
+  ---------->          results go to sink, so that the compiler keeps the
+  ---------->          calls.
+  ----------> returns the number of operations. */
+{
+  struct move2 movelist[MAXMOVES];
+  long ops = 0;
+  int i, j, x = 0;
+
+  for (; rounds > 0; rounds--)
+    for (i = 0; i < n; i++)
+      switch (kernel)
+	{
+	case 0:
+	  x += generatemovelist (boards[i], movelist, colors[i]);
+	  ops++;
+	  break;
+	case 1:
+	  x += generatecapturelist (boards[i], movelist, colors[i]);
+	  ops++;
+	  break;
+	case 2:
+	  x += testcapture (boards[i], colors[i]);
+	  x += testcapture (boards[i], colors[i] ^ CHANGECOLOR);
+	  ops += 2;
+	  break;
+	case 3:
+	  for (j = 0; j < counts[i]; j++)
+	    {
+	      domove (boards[i], moves[i][j]);
+	      x += boards[i][moves[i][j].m[1] % 256];
+	      undomove (boards[i], moves[i][j]);
+	    }
+	  ops += counts[i];
+	  break;
+	case 4:
+	  x += evaluation (boards[i], colors[i], defaultweights);
+	  ops++;
+	  break;
+	}
+  *sink = x;
+  return (ops);
+}
+
+void
+printboard (int human, int b[46], int color)
+/*----------> purpose: print the checkerboard
+  ----------> version: 1.0
+  ----------> date: 24th october 97 */
+/*----------> modified pch, to print
+  ----------> reverse board, 99-02-09 */
+{
+  int i, j;
+  char c[18] = "     wb  WB     --";
+
+  if (human == BLACK)
+    {
+      if (color == BLACK)
+	printf ("\n   --------------- ");
+      else
+	printf ("\n.  --------------- ");
+      for (i = 37; i >= 10; i -= 9)
+	{
+	  printf ("\n   ");
+	  for (j = i; j <= i + 3; j++)
+	    printf ("  %c ", c[b[j]]);
+	  printf ("\n   ");
+	  for (j = i - 5; j <= i - 2; j++)
+	    printf ("%c   ", c[b[j]]);
+	}
+    }
+  else
+    /* human == WHITE */
+    {
+      if (color == WHITE)
+	printf ("\n*  --------------- ");
+      else
+	printf ("\n-  --------------- ");
+      for (i = 10; i <= 37; i += 9)
+	{
+	  printf ("\n   ");
+	  for (j = i - 2; j >= i - 5; j--)
+	    printf ("  %c ", c[b[j]]);
+	  printf ("\n   ");
+	  for (j = i + 3; j >= i; j--)
+	    printf ("%c   ", c[b[j]]);
+	}
+    }
+  printf ("\n\n");
+}
+
+/*-------------- PART II: SEARCH --------------------------------------------*/
+
+
+void
+defaultoptions (struct options *opt)
+/*----------> purpose: fill opt with the default engine options */
+{
+  opt->threads = 1;
+  opt->hashbits = HASHBITS;
+  opt->driver = ALPHABETA;
+  opt->lmr = 1;
+  opt->futility = 1;
+  opt->probcut = 0;
+  /* fitted with probcutfit -depth 12 on the bench positions */
+  opt->pcslope = PCSLOPE;
+  opt->pcoffset = PCOFFSET;
+  opt->pcsigma = PCSIGMA;
+  opt->pcthreshold = 1.5;
+  opt->stats = 0;
+  opt->ponder = 0;
+  memcpy (opt->weights, defaultweights, sizeof (opt->weights));
+  opt->store = NULL;
+  opt->hashfile = NULL;
+  opt->hashshm = NULL;
+#ifdef TRACE
+  opt->trace = NULL;
+#endif
+}
+
+int
+setoption (struct options *opt, char *name, char *value)
+/*----------> purpose: set the engine option called name from the string
+  ---------->          value. options take effect in engines created
+  ---------->          afterwards. the file names are copies owned by opt.
+  ----------> returns 0 if there is no such option or memory runs out. */
+{
+  int n = atoi (value);
+  int i;
+  struct store *s;
+
+  if (!strcmp (name, "threads"))
+    opt->threads = (n < 1) ? 1 : (n > MAXTHREADS) ? MAXTHREADS : n;
+  else if (!strcmp (name, "hashbits"))
+    opt->hashbits = (n < 10) ? 10 : (n > 30) ? 30 : n;
+  else if (!strcmp (name, "driver") && !strcmp (value, "alphabeta"))
+    opt->driver = ALPHABETA;
+  else if (!strcmp (name, "driver") && !strcmp (value, "mtdf"))
+    opt->driver = MTDF;
+  else if (!strcmp (name, "lmr"))
+    opt->lmr = (n != 0);
+  else if (!strcmp (name, "futility"))
+    opt->futility = (n != 0);
+  else if (!strcmp (name, "probcut"))
+    opt->probcut = (n != 0);
+  else if (!strcmp (name, "pcslope") && atof (value) > 0)
+    opt->pcslope = atof (value);
+  else if (!strcmp (name, "pcoffset"))
+    opt->pcoffset = atof (value);
+  else if (!strcmp (name, "pcsigma"))
+    opt->pcsigma = atof (value);
+  else if (!strcmp (name, "pcthreshold"))
+    opt->pcthreshold = atof (value);
+  else if (!strcmp (name, "stats"))
+    opt->stats = (n != 0);
+  else if (!strcmp (name, "ponder"))
+    opt->ponder = (n != 0);
+  else if (!strcmp (name, "weights"))
+    return (loadweights (opt->weights, value));
+  else if (!strcmp (name, "store"))
+    {
+      /* create it now, so that a bad file is an error here */
+      if ((s = openstore (value, STOREBITS)) == NULL)
+	return (0);
+      closestore (s);
+      return (optionname (&opt->store, value));
+    }
+  else if (!strcmp (name, "hashfile"))
+    return (optionname (&opt->hashfile, value));
+  else if (!strcmp (name, "hashshm") && value[0] == '/')
+    return (optionname (&opt->hashshm, value));
+#ifdef TRACE
+  else if (!strcmp (name, "trace"))
+    return (optionname (&opt->trace, value));
+#endif
+  else
+    {
+      for (i = 0; i < NWEIGHTS; i++)
+	if (!strcmp (name, weightnames[i]))
+	  {
+	    opt->weights[i] = n;
+	    return (1);
+	  }
+      return (0);
+    }
+  return (1);
+}
+
+int
+optionname (char **option, char *value)
+/*----------> purpose: set the file name *option to a copy of value, freeing
+  ---------->          the one it had.
+  ----------> returns 1, or 0 if memory runs out; *option is kept then. */
+{
+  char *copy;
+
+  if ((copy = strdup (value)) == NULL)
+    return (0);
+  free (*option);
+  *option = copy;
+  return (1);
+}
+
+int
+samename (char *a, char *b)
+/*----------> purpose: compare two file name options, either may be NULL.
+  ----------> returns 1 if they are the same. */
+{
+  return (a == b || (a && b && !strcmp (a, b)));
+}
+
+int
+copyoptions (struct options *to, struct options *from)
+/*----------> purpose: copy the options from into to, with copies of their
+  ---------->          file names, so that setoption and freeoptions on
+  ---------->          either leave the other intact.
+  ----------> returns 1, or 0 if memory runs out; to has no file names then. */
+{
+  *to = *from;
+  to->store = to->hashfile = to->hashshm = NULL;
+#ifdef TRACE
+  to->trace = NULL;
+#endif
+  if ((from->store && !optionname (&to->store, from->store))
+      || (from->hashfile && !optionname (&to->hashfile, from->hashfile))
+      || (from->hashshm && !optionname (&to->hashshm, from->hashshm))
+#ifdef TRACE
+      || (from->trace && !optionname (&to->trace, from->trace))
+#endif
+    )
+    {
+      freeoptions (to);
+      return (0);
+    }
+  return (1);
+}
+
+void
+freeoptions (struct options *opt)
+/*----------> purpose: free the file names of opt */
+{
+  free (opt->store);
+  free (opt->hashfile);
+  free (opt->hashshm);
+  opt->store = opt->hashfile = opt->hashshm = NULL;
+#ifdef TRACE
+  free (opt->trace);
+  opt->trace = NULL;
+#endif
+}
+
+int
+loadweights (int w[NWEIGHTS], char *filename)
+/*----------> purpose: read evaluation weights from filename, a line "name
+  ---------->          value" for each weight to change, as printweights
+  ---------->          writes them. # starts a comment.
+  ----------> returns 0 if the file cannot be read or has an unknown name,
+  ---------->          leaving w as it was. */
+{
+  FILE *fp;
+  char line[256], name[64];
+  int new[NWEIGHTS];
+  int i, value;
+
+  if ((fp = fopen (filename, "r")) == NULL)
+    {
+      perror (filename);
+      return (0);
+    }
+  memcpy (new, w, sizeof (new));
+  while (fgets (line, sizeof (line), fp))
+    {
+      if (line[0] == '#' || sscanf (line, "%63s %d", name, &value) != 2)
+	continue;
+      for (i = 0; i < NWEIGHTS && strcmp (name, weightnames[i]); i++)
+	;
+      if (i == NWEIGHTS)
+	{
+	  fprintf (stderr, "simplech: %s: no weight %s\n", filename, name);
+	  fclose (fp);
+	  return (0);
+	}
+      new[i] = value;
+    }
+  fclose (fp);
+  memcpy (w, new, sizeof (new));
+  return (1);
+}
+
+void
+printweights (FILE *fp, int w[NWEIGHTS])
+/*----------> purpose: write the evaluation weights w for loadweights. */
+{
+  int i;
+
+  for (i = 0; i < NWEIGHTS; i++)
+    fprintf (fp, "%s %i\n", weightnames[i], w[i]);
+}
+
+struct engine *
+newengine (struct options *opt)
+/*----------> purpose: create an engine with its own hashtable. engines share
+  ---------->          no mutable state, each may search on its own thread,
+  ---------->          but the analysis store of opt->store, which is
+  ---------->          shared through the file. the hashtable is loaded
+  ---------->          from opt->hashfile if that exists. with
+  ---------->          opt->hashshm, the hashtable is in that shared
+  ---------->          memory, with all other engines and processes which
+  ---------->          name it.
+  ----------> returns NULL if out of memory or the store or shared memory
+  ---------->          cannot be opened.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct engine *e;
+
+  pthread_once (&zobristonce, initzobrist);
+  if ((e = calloc (1, sizeof (struct engine))) == NULL)
+    return (NULL);
+  if (!copyoptions (&e->opt, opt))
+    {
+      free (e);
+      return (NULL);
+    }
+  e->hashmask = ((uint64_t) 1 << opt->hashbits) - 1;
+  if (opt->hashshm)
+    {
+      e->hashtable = sharedhashtable (opt->hashshm, opt->hashbits, &e->hashmask);
+      e->hashshared = 1;
+    }
+  else
+    e->hashtable = calloc (e->hashmask + 1, sizeof (struct hashentry));
+  if (e->hashtable == NULL)
+    {
+      freeoptions (&e->opt);
+      free (e);
+      return (NULL);
+    }
+  if (opt->store && (e->store = openstore (opt->store, STOREBITS)) == NULL)
+    {
+      freeengine (e);
+      return (NULL);
+    }
+  /* a warm start, if there is a saved hashtable */
+  if (opt->hashfile && access (opt->hashfile, F_OK) == 0)
+    loadhashtable (e, opt->hashfile);
+  return (e);
+}
+
+void
+freeengine (struct engine *e)
+{
+  if (e == NULL)
+    return;
+  if (e->store)
+    closestore (e->store);
+  if (e->hashshared)
+    munmap (e->hashtable, (e->hashmask + 1) * sizeof (struct hashentry));
+  else
+    free (e->hashtable);
+  freeoptions (&e->opt);
+  free (e);
+}
+
+void
+gamestart (struct engine *e, int b[46], int color)
+/*----------> purpose: forget the game history of e, a game starts on board b
+  ---------->          with color to move. the moves played are then told to
+  ---------->          the engine with gamemove, so that its search knows
+  ---------->          which positions have been on the board.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  e->game[0] = hashposition (b, color);
+  e->gameplies = 1;
+  e->gamereversible = 0;
+}
+
+int
+gamemove (struct engine *e, struct move2 move)
+/*----------> purpose: record that move was played in the game. only king
+  ---------->          moves without capture are reversible.
+  ----------> returns how often the new position was on the board before. */
+{
+  if (e->gameplies == 0)
+    return (0);
+  e->game[e->gameplies % GAMERING] = hashupdate (e->game[(e->gameplies - 1) % GAMERING], move);
+  e->gameplies++;
+  if (move.n == 2 && ((move.m[0] >> 8) & KING))
+    e->gamereversible++;
+  else
+    e->gamereversible = 0;
+  return (gamerepetitions (e));
+}
+
+int
+gamerepetitions (struct engine *e)
+/*----------> purpose: how often the current position of the game was on the
+  ---------->          board before */
+{
+  uint64_t key;
+  int i, n = 0;
+
+  if (e->gameplies == 0)
+    return (0);
+  key = e->game[(e->gameplies - 1) % GAMERING];
+  for (i = 4; i <= e->gamereversible && i < e->gameplies && i < GAMERING; i += 2)
+    if (e->game[(e->gameplies - 1 - i) % GAMERING] == key)
+      n++;
+  return (n);
+}
+
+int
+gamehistory (struct engine *e, uint64_t key, uint64_t *path)
+/*----------> purpose: copy the positions of the game since the last
+  ---------->          irreversible move to path, oldest first, if the game
+  ---------->          ends in the position with hash key. the search root is
+  ---------->          then at path + the number returned; with no game or a
+  ---------->          search from another position that is 0.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int i, n;
+
+  if (e->gameplies == 0 || e->game[(e->gameplies - 1) % GAMERING] != key)
+    return (0);
+  n = e->gamereversible;
+  if (n > e->gameplies - 1)
+    n = e->gameplies - 1;
+  if (n > GAMERING - 1)
+    n = GAMERING - 1;
+  for (i = 0; i < n; i++)
+    path[i] = e->game[(e->gameplies - 1 - n + i) % GAMERING];
+  return (n);
+}
+
+int
+checkers (int b[46], int color, double maxtime, char *str)
+/*----------> purpose: the original entry point, kept for interfaces written
+  ---------->          against it. it searches with one engine for the whole
+  ---------->          process and is not reentrant; use searchmove.
+  ----------> version: 1.3
+  ----------> date: 18th october 2026 */
+{
+  static struct engine *e;
+  struct options opt;
+
+  if (e == NULL)
+    {
+      defaultoptions (&opt);
+      if ((e = newengine (&opt)) == NULL)
+	return (0);
+      e->out = stdout;
+    }
+  return (searchmove (e, b, color, maxtime, str));
+}
+
+int
+searchmove (struct engine *e, int b[46], int color, double maxtime, char *str)
+/*----------> purpose: find a move on board b for color with engine e in the
+  ---------->          time specified by maxtime, write the best move in
+  ---------->          board, returns information on the search in str
+  ----------> returns 1 if a move is found & executed, 0, if there is no legal
+  ----------> move in this position.
+  ----------> version: 1.2
+  ----------> date: 18th october 2026 */
+{
+  struct limits lim = {0};
+
+  lim.time = maxtime;
+  return (enginemove (e, b, color, &lim, str));
+}
+
+int
+enginemove (struct engine *e, int b[46], int color, struct limits *lim, char *str)
+/*----------> purpose: like searchmove, with the search limited by lim, which
+  ---------->          may be a game clock.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int numberofmoves;
+  double start;
+  int eval, depth;
+  long nodes;
+  struct move2 best, movelist[MAXMOVES];
   char msg[80];
+  /* the move played continues the game of e, if this is its position */
+  int ingame = (e->gameplies && e->game[(e->gameplies - 1) % GAMERING] == hashposition (b, color));
+
+/*--------> check if there is only one move */
+  numberofmoves = generatecapturelist (b, movelist, color);
+  if (numberofmoves == 1)
+    {
+      domove (b, movelist[0]);
+      if (ingame)
+	gamemove (e, movelist[0]);
+      sprintf (str, "forced capture");
+      movetonotation (movelist[0], msg);	/* pch */
+      if (e->out)
+	fprintf (e->out, "program chooses %s\n", msg);	/* pch */
+      return (1);
+    }
+  numberofmoves += generatemovelist (b, movelist, color); /* pch += */
+  if (numberofmoves == 1)
+    {
+      domove (b, movelist[0]);
+      if (ingame)
+	gamemove (e, movelist[0]);
+      sprintf (str, "only move");
+      movetonotation (movelist[0], msg);	/* pch */
+      if (e->out)
+	fprintf (e->out, "program chooses %s\n", msg);	/* pch */
+      return (1);
+    }
+/*--------> check if there is a move at all */
+  if (numberofmoves == 0)
+    return (0);
+
+  start = walltime ();
+  nodes = smpsearch (e, b, color, lim, &best, &eval, &depth);
+  sprintf (str, "\n\ntime %2.2f, depth %i, eval %i, nodes %li, overshoot %.1f ms",
+	   walltime () - start, depth, eval, nodes, 1000 * e->overshoot);
+  domove (b, best);
+  if (ingame)
+    gamemove (e, best);
+  movetonotation (best, msg);	/* pch */
+  if (e->out)
+    {
+      fprintf (e->out, "deadline %.3f s, overshoot %+.1f ms\n", e->allotted, 1000 * e->overshoot);
+      if (e->opt.stats)
+	{
+	  fprintf (e->out, "stats ");
+	  statsjson (e->out, e);
+	  fprintf (e->out, "\n");
+	}
+      fprintf (e->out, "program chooses %s\n", msg);	/* pch */
+    }
+
+  return (1);
+}
+
+int
+expectedreply (struct engine *e, int b[46], int color, struct move2 *reply)
+/*----------> purpose: the move the last search expects color to play on b,
+  ---------->          from the hashtable.
+  ----------> returns 1, or 0 if the hashtable does not know one. */
+{
+  struct move2 movelist[MAXMOVES];
+  int i, n, code, value;
+
+  hashprobe (e, hashposition (b, color), 0, 0, 0, &value, &code);
+  if (code == 0)
+    return (0);
+  n = generatecapturelist (b, movelist, color);
+  if (n == 0)
+    n = generatemovelist (b, movelist, color);
+  for (i = 0; i < n; i++)
+    if (movecode (movelist[i]) == code)
+      {
+	*reply = movelist[i];
+	return (1);
+      }
+  return (0);
+}
+
+int
+hashpv (struct engine *e, int b[46], int color, struct move2 best, int depth, struct move2 pv[MAXPV])
+/*----------> purpose: the principal variation of a search to depth on b
+  ---------->          for color: best, then the moves the hashtable of e
+  ---------->          expects, until it does not know one, a position
+  ---------->          repeats, or depth moves.
+  ----------> returns the number of moves in pv. */
+{
+  int i, n = 0;
+  int board[46];
+  uint64_t key[MAXPV + 1];
+
+  memcpy (board, b, sizeof (board));
+  key[0] = hashposition (board, color);
+  pv[0] = best;
+  if (depth > MAXPV)
+    depth = MAXPV;
+  while (n < depth || n == 0)
+    {
+      if (n > 0 && !expectedreply (e, board, color, &pv[n]))
+	break;
+      domove (board, pv[n]);
+      color ^= CHANGECOLOR;
+      key[++n] = hashposition (board, color);
+      for (i = 0; i < n && key[i] != key[n]; i++)
+	;
+      if (i < n)
+	break;
+    }
+  return (n);
+}
+
+struct search *
+startsearch (struct engine *e, int b[46], int color, struct limits *lim,
+	     void (*progress) (struct searchinfo *info, void *arg), void *arg)
+/*----------> purpose: search a copy of board b for color with engine e
+  ---------->          within lim on a thread of its own, and return at
+  ---------->          once. after each iteration, progress, if not NULL,
+  ---------->          is called on the search thread with its depth,
+  ---------->          score, nodes and principal variation; once more,
+  ---------->          with info->done set, when the search is over. the
+  ---------->          search stops early when cancelsearch is called;
+  ---------->          searchdone tells if it is over, waitsearch waits
+  ---------->          for it and gives the result. e may not be used
+  ---------->          otherwise until then. e->pondering is honoured, the
+  ---------->          move is not played, and e->playnow is e's own again
+  ---------->          after waitsearch.
+  ----------> returns the handle of the search, or NULL if it cannot be
+  ---------->          started.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  struct search *s;
+
+  if ((s = newsearch (e, b, color, lim, progress, arg)) == NULL)
+    return (NULL);
+  if (pthread_create (&s->thread, NULL, runsearch, s))
+    {
+      waitsearch (s, NULL);
+      return (NULL);
+    }
+  s->threaded = 1;
+  return (s);
+}
+
+struct search *
+newsearch (struct engine *e, int b[46], int color, struct limits *lim,
+	   void (*progress) (struct searchinfo *info, void *arg), void *arg)
+/*----------> purpose: startsearch, but without the thread: the search is
+  ---------->          run by runsearch on a thread of the caller's, e.g.
+  ---------->          of a pool, and waitsearch frees it once that has
+  ---------->          returned.
+  ----------> returns the handle of the search, or NULL if out of memory. */
+{
+  struct search *s;
+
+  if ((s = calloc (1, sizeof (struct search))) == NULL)
+    return (NULL);
+  s->e = e;
+  memcpy (s->b, b, sizeof (s->b));
+  s->color = color;
+  s->lim = *lim;
+  s->progress = progress;
+  s->arg = arg;
+  s->playnow = e->playnow;
+  s->start = walltime ();
+  e->playnow = &s->cancel;
+  e->iterated = searchprogress;
+  e->iteratedarg = s;
+  return (s);
+}
+
+void
+cancelsearch (struct search *s)
+/*----------> purpose: stop the search of s; it ends with the best move of
+  ---------->          its last complete iteration. */
+{
+  s->cancel = 1;
+}
+
+int
+searchdone (struct search *s)
+/*----------> purpose: poll the search of s.
+  ----------> returns 1 if it is over, 0 if it still runs. */
+{
+  return (__atomic_load_n (&s->done, __ATOMIC_ACQUIRE));
+}
+
+int
+waitsearch (struct search *s, struct searchinfo *result)
+/*----------> purpose: wait for the search of s to end, write its result
+  ---------->          to result, if not NULL, and free s.
+  ----------> returns 1 if there is a best move, result->pv[0], 0 if the
+  ---------->          side to move has none. */
+{
+  int found;
+
+  if (s->threaded)
+    pthread_join (s->thread, NULL);
+  found = (s->result.pvlength > 0);
+  if (result)
+    *result = s->result;
+  s->e->playnow = s->playnow;
+  s->e->iterated = NULL;
+  free (s);
+  return (found);
+}
+
+void *
+runsearch (void *arg)
+/*----------> purpose: run the search of the handle arg, the thread of
+  ---------->          startsearch */
+{
+  struct search *s = arg;
+  struct searchinfo *r = &s->result;
+  struct move2 best, movelist[MAXMOVES];
+  int n;
+
+  n = generatecapturelist (s->b, movelist, s->color);
+  if (n == 0)
+    n = generatemovelist (s->b, movelist, s->color);
+  if (n)
+    {
+      r->nodes = smpsearch (s->e, s->b, s->color, &s->lim, &best, &r->value, &r->depth);
+      r->pvlength = hashpv (s->e, s->b, s->color, best, r->depth, r->pv);
+    }
+  r->time = walltime () - s->start;
+  r->done = 1;
+  if (s->progress)
+    s->progress (r, s->arg);
+  __atomic_store_n (&s->done, 1, __ATOMIC_RELEASE);
+  return (NULL);
+}
+
+void
+searchprogress (struct engine *e, struct move2 best, void *arg)
+/*----------> purpose: the iterated hook of startsearch: tell the caller
+  ---------->          about the iteration e has just completed. */
+{
+  struct search *s = arg;
+  struct searchinfo info;
+  int i;
+
+  if (s->progress == NULL)
+    return;
+  info.depth = e->iteration[e->iterations - 1].depth;
+  info.value = e->iteration[e->iterations - 1].value;
+  for (info.nodes = 0, i = 0; i < e->iterations; i++)
+    info.nodes += e->iteration[i].nodes;
+  info.time = walltime () - s->start;
+  info.pvlength = hashpv (e, s->b, s->color, best, info.depth, info.pv);
+  info.done = 0;
+  s->progress (&info, s->arg);
+}
+
+long
+smpsearch (struct engine *e, int b[46], int color, struct limits *lim, struct move2 *best, int *eval, int *depth)
+/*----------> purpose: lazy smp iterative deepening. the main thread and
+  ---------->          threads-1 helpers search the same position and share
+  ---------->          the hashtable of e; only the main thread's result
+  ---------->          counts. deepening stops when one of the limits in lim
+  ---------->          is reached.
+  ---------->          the time and node limits are enforced inside the
+  ---------->          search: an iteration which runs out is abandoned and
+  ---------->          the result of the last complete one is returned.
+  ---------->          with a game clock, the time per move is allocated by
+  ---------->          allocatetime and adapted to the search as it goes.
+  ---------->          while e->pondering is set, no limit applies; they
+  ---------->          count from e->ponderhit once it is cleared, and the
+  ---------->          search does not return before that or a stop.
+  ---------->          with an analysis store, a stored result at least as
+  ---------->          deep as lim->depth, or of at least lim->nodes, is
+  ---------->          returned without a search; a shallower one seeds
+  ---------->          the hashtable. the result goes to the store.
+  ---------->          stored results are keyed by the position alone: the
+  ---------->          weights, driver, probcut and game history of the
+  ---------->          search that made them are not checked.
+  ---------->          e->iterated, if set, is called with the best move
+  ---------->          after each completed iteration.
+  ---------->          out of memory, the first legal move is returned at
+  ---------->          depth 0 without a search.
+  ----------> returns the number of nodes searched by all threads.
+  ----------> version: 1.8
+  ----------> date: 18th october 2026 */
+{
+  int i, n, helpers;
+  int threads = e->opt.threads;
+  int value, drop;
+  int stable = 0, tested = 0;
+  double start, soft, hard, scale = 1.0;
+  double mark, clock;
+  int pondered = e->pondering;
+  long nodes = 0;
+  struct move2 move, movelist[MAXMOVES];
+  struct searchthread *t;
+  uint64_t key = hashposition (b, color);
+  int code, stored;
+#ifdef TRACE
+  int tracefd = -1;
+  uint32_t search = 0;
+#endif
+
+  e->hashage++;
+  memset (&e->stats, 0, sizeof (e->stats));
+  e->iterations = 0;
+/*----------> the analysis store may know the answer */
+  if (e->store && !e->pondering && storeprobe (e->store, key, &stored, &value, &code, &nodes))
+    {
+      if ((lim->depth && stored >= lim->depth) || (!lim->depth && lim->nodes && nodes >= lim->nodes))
+	{
+	  n = generatecapturelist (b, movelist, color);
+	  if (n == 0)
+	    n = generatemovelist (b, movelist, color);
+	  for (i = 0; i < n && movecode (movelist[i]) != code; i++)
+	    ;
+	  if (i < n)
+	    {
+	      *best = movelist[i];
+	      *eval = value;
+	      *depth = stored;
+	      e->allotted = e->overshoot = e->searchtime = 0;
+#ifndef MUTE
+	      if (e->out)
+		fprintf (e->out, "stored: d %2i, v %4i, %li nodes\n", stored, value, nodes);
+#endif
+	      return (0);
+	    }
+	}
+      hashstore (e, key, stored, value, EXACT, code);
+      nodes = 0;
+    }
+  if ((t = calloc (threads, sizeof (struct searchthread))) == NULL)
+    {
+      /* no search, but a legal move to play */
+      fprintf (stderr, "simplech: out of memory\n");
+      n = generatecapturelist (b, movelist, color);
+      if (n == 0)
+	n = generatemovelist (b, movelist, color);
+      if (n)
+	*best = movelist[0];
+      *eval = 0;
+      *depth = 0;
+      e->allotted = e->overshoot = e->searchtime = 0;
+      return (0);
+    }
+#ifdef TRACE
+  if (e->opt.trace && (tracefd = open (e->opt.trace, O_WRONLY | O_CREAT | O_APPEND, 0644)) >= 0)
+    search = __atomic_add_fetch (&tracesearches, 1, __ATOMIC_RELAXED);
+#endif
+  for (n = 0; n < threads; n++)
+    {
+      t[n].e = e;
+      t[n].id = n;
+      t[n].color = color;
+      memcpy (t[n].b, b, sizeof (t[n].b));
+      t[n].key = t[n].path + gamehistory (e, hashposition (b, color), t[n].path);
+      t[n].key[0] = hashposition (b, color);
+      t[n].reversible[0] = t[n].key - t[n].path;
+#ifdef TRACE
+      if (tracefd >= 0)
+	t[n].trace = malloc ((TRACEEVENTS + 1) * sizeof (struct traceevent));
+      t[n].tracefd = tracefd;
+      t[n].search = search;
+#endif
+    }
+
+  e->stop = 0;
+  e->deadline = 0;
+  e->allotted = 0;
+  e->nodelimit = 0;
+  start = walltime ();
+  for (helpers = 1; helpers < threads; helpers++)
+    if (pthread_create (&t[helpers].thread, NULL, helpersearch, &t[helpers]))
+      break;
+
+  *eval = firstalphabeta (&t[0], t[0].b, 1, -10000, 10000, color, best);
+  recorditeration (e, 1, *eval, t[0].stats.nodes, walltime () - start);
+  if (e->iterated)
+    e->iterated (e, *best, e->iteratedarg);
+/*----------> from now on there is a move to fall back on, arm the limits.
+  ----------> an iteration takes about as long as all before it together,
+  ----------> so none is started after soft, which is half of hard for a
+  ----------> fixed time per move. */
+  if (lim->remaining)
+    allocatetime (b, lim, &soft, &hard);
+  else
+    {
+      soft = lim->time / 2;
+      hard = lim->time;
+    }
+  e->allotted = hard;
+  if (hard && !e->pondering)
+    e->deadline = start + hard;
+  e->nodelimit = lim->nodes;
+  for (i = 2; i <= MAXDEPTH; i++)
+    {
+      clock = pondered ? e->ponderhit : start;
+      if (!e->pondering
+	  && ((lim->depth && i > lim->depth)
+	      || (soft && walltime () - clock >= soft * scale)
+	      || (lim->nodes && t[0].stats.nodes >= lim->nodes)))
+	break;
+      move = *best;
+      nodes = t[0].stats.nodes;
+      mark = walltime ();
+      value = iterate (&t[0], i, *eval, &move);
+      if (e->stop)
+	break;
+      recorditeration (e, i, value, t[0].stats.nodes - nodes, walltime () - mark);
+/*----------> on a game clock, save time while the best move is stable and
+  ----------> spend more while the score is dropping */
+      if (lim->remaining && i >= 4)
+	{
+	  stable = (movecode (move) == movecode (*best)) ? stable + 1 : 0;
+	  drop = (color == BLACK) ? *eval - value : value - *eval;
+	  if (drop >= SCOREDROP)
+	    scale = 2.0;
+	  else if (stable >= 3)
+	    scale = 0.5;
+	  else
+	    scale = 1.0;
+	}
+      *eval = value;
+      *best = move;
+      if (e->iterated)
+	e->iterated (e, *best, e->iteratedarg);
+#ifndef MUTE
+      if (e->out)
+	fprintf (e->out, "t %2.2f, d %2i, v %4i\n", walltime () - start, i, *eval);
+#endif
+/*----------> once per move, stop early if one move is clearly the best */
+      if (lim->remaining && !tested && !e->pondering && i >= 6 && walltime () - clock >= soft / 5)
+	{
+	  tested = 1;
+	  if (clearlybest (&t[0], i, color, *best, *eval))
+	    {
+	      i++;
+	      break;
+	    }
+	}
+    }
+  *depth = i - 1;
+/*----------> a ponder search which ran out of depths waits for the move */
+  while (e->pondering && !e->stop && !(e->playnow && *e->playnow))
+    usleep (1000);
+
+  e->stop = 1;
+  clock = pondered ? e->ponderhit : start;
+  e->overshoot = hard ? walltime () - clock - hard : 0;
+  for (n = 1; n < helpers; n++)
+    pthread_join (t[n].thread, NULL);
+  for (n = 0; n < threads; n++)
+    addstats (&e->stats, &t[n].stats);
+  e->searchtime = walltime () - start;
+#ifdef TRACE
+  for (n = 0; n < threads; n++)
+    if (t[n].trace)
+      {
+	traceflush (&t[n]);
+	free (t[n].trace);
+      }
+  if (tracefd >= 0)
+    close (tracefd);
+#endif
+  free (t);
+  if (e->store && *depth >= 1)
+    storeupdate (e->store, key, *depth, *eval, movecode (*best), e->stats.nodes);
+  return (e->stats.nodes);
+}
+
+void
+recorditeration (struct engine *e, int depth, int value, long nodes, double time)
+{
+  struct iteration *it = &e->iteration[e->iterations++];
+
+  it->depth = depth;
+  it->value = value;
+  it->nodes = nodes;
+  it->time = time;
+}
+
+void
+addstats (struct searchstats *sum, struct searchstats *s)
+{
+  int i;
+
+  sum->nodes += s->nodes;
+  sum->qnodes += s->qnodes;
+  sum->evaluations += s->evaluations;
+  sum->movelists += s->movelists;
+  sum->capturelists += s->capturelists;
+  sum->hashprobes += s->hashprobes;
+  sum->hashhits += s->hashhits;
+  sum->hashcuts += s->hashcuts;
+  for (i = 0; i < CUTINDEX; i++)
+    sum->cutoffs[i] += s->cutoffs[i];
+}
+
+void
+statsjson (FILE *fp, struct engine *e)
+/*----------> purpose: write the statistics of the last search of e to fp as
+  ---------->          one json object. the counters are summed over all
+  ---------->          threads; the iterations are those the main thread
+  ---------->          completed, with the effective branching factor as the
+  ---------->          ratio of the nodes of one iteration to the last.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct searchstats *s = &e->stats;
+  struct iteration *it;
+  int i;
+
+  fprintf (fp, "{\"nodes\":%li,\"qnodes\":%li,\"time\":%.3f,\"nps\":%.0f,"
+	   "\"evaluations\":%li,\"movelists\":%li,\"capturelists\":%li,"
+	   "\"hashprobes\":%li,\"hashhits\":%li,\"hashcuts\":%li,\"cutoffs\":[",
+	   s->nodes, s->qnodes, e->searchtime, e->searchtime > 0 ? s->nodes / e->searchtime : 0,
+	   s->evaluations, s->movelists, s->capturelists,
+	   s->hashprobes, s->hashhits, s->hashcuts);
+  for (i = 0; i < CUTINDEX; i++)
+    fprintf (fp, i ? ",%li" : "%li", s->cutoffs[i]);
+  fprintf (fp, "],\"iterations\":[");
+  for (i = 0; i < e->iterations; i++)
+    {
+      it = &e->iteration[i];
+      fprintf (fp, "%s{\"depth\":%i,\"value\":%i,\"nodes\":%li,\"time\":%.4f,\"ebf\":%.2f}",
+	       i ? "," : "", it->depth, it->value, it->nodes, it->time,
+	       (i && it[-1].nodes) ? (double) it->nodes / it[-1].nodes : 0.0);
+    }
+  fprintf (fp, "]}");
+}
+
+char *
+statsstring (struct engine *e)
+/*----------> purpose: statsjson into a string, which the caller frees */
+{
+  char *str = NULL;
+  size_t size;
+  FILE *fp;
+
+  if ((fp = open_memstream (&str, &size)) == NULL)
+    return (NULL);
+  statsjson (fp, e);
+  fclose (fp);
+  return (str);
+}
 
-#ifdef STATISTICS
-  alphabetas = 0;
-  generatemovelists = 0;
-  generatecapturelists = 0;
-  evaluations = 0;
-#endif
+void
+allocatetime (int b[46], struct limits *lim, double *soft, double *hard)
+/*----------> purpose: split the game clock in lim into the time for this
+  ---------->          move. soft is the time after which no new iteration
+  ---------->          is started, hard the deadline. without a moves to go
+  ---------->          count, the number of moves left is estimated from the
+  ---------->          pieces on the board; the middlegame gets the most.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int i, pieces = 0;
+  int movesleft;
+  double available, phase;
 
-/*--------> check if there is only one move */
-  numberofmoves = generatecapturelist (b, movelist, color);
-  if (numberofmoves == 1)
-    {
-      domove (b, movelist[0]);
-      sprintf (str, "forced capture");
-      movetonotation (movelist[0], msg);	/* pch */
-      printf ("program chooses %s\n", msg);	/* pch */
-      return (1);
-    }
-  numberofmoves += generatemovelist (b, movelist, color); /* pch += */
-  if (numberofmoves == 1)
+  for (i = 5; i <= 40; i++)
+    if (b[i] & (BLACK | WHITE))
+      pieces++;
+  movesleft = lim->movestogo ? lim->movestogo : 12 + pieces;
+  if (pieces >= 20)
+    phase = 0.8;		/* opening, the moves are well known */
+  else if (pieces >= 10)
+    phase = 1.3;		/* middlegame, where games are decided */
+  else
+    phase = 1.0;
+
+  available = lim->remaining + (movesleft - 1) * lim->increment - movesleft * MOVEOVERHEAD;
+  if (available < 0)
+    available = 0;
+  *soft = phase * available / movesleft;
+  *hard = 4 * *soft;
+  /* never risk more than half the clock on one move */
+  if (*hard > (lim->remaining - MOVEOVERHEAD) / 2)
+    *hard = (lim->remaining - MOVEOVERHEAD) / 2;
+  if (*hard < 0.001)
+    *hard = 0.001;
+  if (*soft > *hard)
+    *soft = *hard;
+}
+
+int
+clearlybest (struct searchthread *t, int depth, int color, struct move2 best, int eval)
+/*----------> purpose: test at half the depth with zero windows whether every
+  ---------->          root move but best is worse than eval by more than
+  ---------->          CLEARMARGIN, in which case there is no point in
+  ---------->          searching on.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int i, n, value;
+  int *b = t->b;
+  struct move2 movelist[MAXMOVES];
+
+  if (testcapture (b, color))
+    n = generatecapturelist (b, movelist, color);
+  else
+    n = generatemovelist (b, movelist, color);
+  for (i = 0; i < n; i++)
     {
-      domove (b, movelist[0]);
-      sprintf (str, "only move");
-      movetonotation (movelist[0], msg);	/* pch */
-      printf ("program chooses %s\n", msg);	/* pch */
-      return (1);
+      if (movecode (movelist[i]) == movecode (best))
+	continue;
+      domove (b, movelist[i]);
+      pushkey (t, 0, movelist[i]);
+      if (color == BLACK)
+	value = (alphabeta (t, b, depth / 2, 1, eval - CLEARMARGIN - 1, eval - CLEARMARGIN, WHITE) < eval - CLEARMARGIN);
+      else
+	value = (alphabeta (t, b, depth / 2, 1, eval + CLEARMARGIN, eval + CLEARMARGIN + 1, BLACK) > eval + CLEARMARGIN);
+      undomove (b, movelist[i]);
+      if (!value || t->e->stop)
+	return (0);
     }
-/*--------> check if there is a move at all */
-  if (numberofmoves == 0)
-    return (0);
+  return (1);
+}
 
-  start = clock ();
-  eval = firstalphabeta (b, 1, -10000, 10000, color, &best);
-  for (i = 2; (i <= MAXDEPTH) && ((clock () - start) / TICKS < maxtime); i++)
+void *
+helpersearch (void *arg)
+/*----------> purpose: body of a lazy smp helper thread. iterates like the
+  ---------->          main thread until the engine is stopped, but skips
+  ---------->          some depths so that the helpers spread out over the
+  ---------->          tree.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  static const int skipsize[16] =
+  {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4};
+  static const int skipphase[16] =
+  {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3};
+  struct searchthread *t = arg;
+  struct move2 best;
+  int depth, guess = 0;
+  int k = (t->id - 1) % 16;
+
+  for (depth = 1; (depth <= MAXDEPTH) && !t->e->stop; depth++)
     {
-      eval = firstalphabeta (b, i, -10000, 10000, color, &best);
-#ifndef MUTE
-      printf ("t %2.2f, d %2i, v %4i\n", (clock () - start) / TICKS, i, eval);
-#ifdef STATISTICS
-      printf ("  nod %i, gm %i, gc %i, eva %i",
-	      alphabetas, generatemovelists, generatecapturelists,
-	      evaluations);
-#endif
-#endif
+      if (((depth + skipphase[k]) / skipsize[k]) % 2)
+	continue;
+      guess = iterate (t, depth, guess, &best);
     }
-  i--;
-#ifdef STATISTICS
-  sprintf (str, "\n\nt %2.2f, d %2i, v %4i  nod %i, gm %i, gc %i, eva %i", (clock () - start) / TICKS, i, eval, alphabetas, generatemovelists, generatecapturelists, evaluations);
-#else
-  sprintf (str, "\n\ntime %2.2f, depth %i, eval %i", (clock () - start) / TICKS, i, eval);
-#endif
-  domove (b, best);
-  movetonotation (best, msg);	/* pch */
-  printf ("program chooses %s\n", msg);		/* pch */
-
-  return (1);
+  return (NULL);
 }
 
 int
-firstalphabeta (int b[46], int depth, int alpha, int beta, int color, struct move2 *best)
+#ifdef TRACE
+searchroot (struct searchthread *t, int b[46], int depth, int alpha, int beta, int color, struct move2 *best)
+#else
+firstalphabeta (struct searchthread *t, int b[46], int depth, int alpha, int beta, int color, struct move2 *best)
+#endif
 /*----------> purpose: search the game tree and find the best move.
-  ----------> version: 1.0
-  ----------> date: 25th october 97 */
+  ----------> version: 1.2
+  ----------> date: 18th october 2026 */
 {
   int i;
   int value;
   int numberofmoves;
   int capture;
+  int hashmove, bestmove = 0;
+  int bestvalue = (color == BLACK) ? -10000 : 10000;
+  uint64_t key = t->key[0];
   struct move2 movelist[MAXMOVES];
 
-#ifdef STATISTICS
-  alphabetas++;
-#endif
+  t->stats.nodes++;
 
 /*----------> test if captures are possible */
   capture = testcapture (b, color);
@@ -669,7 +5736,11 @@ firstalphabeta (int b[46], int depth, int alpha, int beta, int color, struct mov
   if (depth == 0)
     {
       if (capture == 0)
-	return (evaluation (b, color));
+	{
+	  t->stats.evaluations++;
+	  TRACEFLAG (t, 0, TRACELEAF);
+	  return (evaluation (b, color, t->e->opt.weights));
+	}
       else
 	depth = 1;
     }
@@ -677,6 +5748,7 @@ firstalphabeta (int b[46], int depth, int alpha, int beta, int color, struct mov
 /*----------> generate all possible moves in the position */
   if (capture == 0)
     {
+      t->stats.movelists++;
       numberofmoves = generatemovelist (b, movelist, color);
 /*----------> if there are no possible moves, we lose: */
       if (numberofmoves == 0)
@@ -688,73 +5760,219 @@ firstalphabeta (int b[46], int depth, int alpha, int beta, int color, struct mov
 	}
     }
   else
-    numberofmoves = generatecapturelist (b, movelist, color);
+    {
+      t->stats.capturelists++;
+      numberofmoves = generatecapturelist (b, movelist, color);
+    }
+
+/*----------> the best move of the last iteration goes first */
+  t->stats.hashprobes++;
+  if (hashprobe (t->e, key, MAXDEPTH + 1, alpha, beta, &value, &hashmove))
+    {
+      t->stats.hashhits++;
+      TRACEFLAG (t, 0, TRACEHIT);
+    }
+  ordermoves (t, movelist, numberofmoves, hashmove, 0);
 
 /*----------> for all moves: execute the move, search tree, undo move. */
   for (i = 0; i < numberofmoves; i++)
     {
       domove (b, movelist[i]);
+      pushkey (t, 0, movelist[i]);
 
-      value = alphabeta (b, depth - 1, alpha, beta, (color ^ CHANGECOLOR));
+      value = alphabeta (t, b, depth - 1, 1, alpha, beta, (color ^ CHANGECOLOR));
 
       undomove (b, movelist[i]);
+      if (t->e->stop)
+	return (0);
       if (color == BLACK)
 	{
 	  if (value >= beta)
-	    return (value);
+	    {
+	      *best = movelist[i];
+	      t->stats.cutoffs[i < CUTINDEX ? i : CUTINDEX - 1]++;
+	      TRACEBEST (t, 0, i);
+	      TRACEFLAG (t, 0, TRACECUT);
+	      hashstore (t->e, key, depth, value, LOWER, movecode (movelist[i]));
+	      return (value);
+	    }
+	  if (value > bestvalue)
+	    bestvalue = value;
 	  if (value > alpha)
 	    {
 	      alpha = value;
 	      *best = movelist[i];
+	      bestmove = movecode (movelist[i]);
+	      TRACEBEST (t, 0, i);
 	    }
 	}
       if (color == WHITE)
 	{
 	  if (value <= alpha)
-	    return (value);
+	    {
+	      *best = movelist[i];
+	      t->stats.cutoffs[i < CUTINDEX ? i : CUTINDEX - 1]++;
+	      TRACEBEST (t, 0, i);
+	      TRACEFLAG (t, 0, TRACECUT);
+	      hashstore (t->e, key, depth, value, UPPER, movecode (movelist[i]));
+	      return (value);
+	    }
+	  if (value < bestvalue)
+	    bestvalue = value;
 	  if (value < beta)
 	    {
 	      beta = value;
 	      *best = movelist[i];
+	      bestmove = movecode (movelist[i]);
+	      TRACEBEST (t, 0, i);
 	    }
 	}
     }
+/*----------> fail soft: without a move inside the window, the result is the
+  ----------> best bound found and *best is left alone */
   if (color == BLACK)
-    return (alpha);
-  return (beta);
+    hashstore (t->e, key, depth, bestvalue, bestmove ? EXACT : UPPER, bestmove);
+  else
+    hashstore (t->e, key, depth, bestvalue, bestmove ? EXACT : LOWER, bestmove);
+  return (bestvalue);
 }
 
 int
-alphabeta (int b[46], int depth, int alpha, int beta, int color)
-/*----------> purpose: search the game tree and find the best move.
+iterate (struct searchthread *t, int depth, int guess, struct move2 *best)
+/*----------> purpose: one iteration of the deepening loop with the driver
+  ---------->          chosen in the engine options; guess is the value of
+  ---------->          the previous iteration. */
+{
+  if (t->e->opt.driver == MTDF)
+    return (mtdf (t, t->b, depth, guess, t->color, best));
+  return (firstalphabeta (t, t->b, depth, -10000, 10000, t->color, best));
+}
+
+int
+mtdf (struct searchthread *t, int b[46], int depth, int guess, int color, struct move2 *best)
+/*----------> purpose: find the minimax value with a series of zero window
+  ---------->          searches converging from guess (plaat's mtd(f)). the
+  ---------->          hashtable carries the work of one pass to the next.
   ----------> version: 1.0
-  ----------> date: 24th october 97 */
+  ----------> date: 18th october 2026 */
+{
+  int g = guess;
+  int beta;
+  int lower = -10000, upper = 10000;
+  struct move2 move;
+
+  while (lower < upper)
+    {
+      beta = (g == lower) ? g + 1 : g;
+      move.n = 0;
+      g = firstalphabeta (t, b, depth, beta - 1, beta, color, &move);
+      if (t->e->stop)
+	return (0);
+      if (g < beta)
+	upper = g;
+      else
+	lower = g;
+      /* a pass only finds a move if it succeeds for the side to move */
+      if (move.n)
+	*best = move;
+    }
+  return (g);
+}
+
+int
+#ifdef TRACE
+searchnode (struct searchthread *t, int b[46], int depth, int ply, int alpha, int beta, int color)
+#else
+alphabeta (struct searchthread *t, int b[46], int depth, int ply, int alpha, int beta, int color)
+#endif
+/*----------> purpose: search the game tree and find the best move.
+  ----------> version: 1.2
+  ----------> date: 18th october 2026 */
 {
   int i;
   int value;
   int capture;
   int numberofmoves;
+  int hashmove, bestmove = 0;
+  int bestvalue = (color == BLACK) ? -10000 : 10000;
+  int searchdepth = depth;
+  int reduction, prune = 0, futile = 0;
+  int bound;
+  struct options *o = &t->e->opt;
+  uint64_t key = t->key[ply];
   struct move2 movelist[MAXMOVES];
+  static const int futilitymargin[3] = {0, 60, 150};
 
-#ifdef STATISTICS
-  alphabetas++;
-#endif
+  t->stats.nodes++;
+  if (t->id == 0 && !(t->stats.nodes & (POLLNODES - 1)))
+    pollstop (t);
+  if (t->e->stop)
+    return (0);
+
+/*----------> a position which was on the board or on the path before is a
+  ----------> draw: it can be repeated forever */
+  if (repetition (t, ply))
+    {
+      TRACEFLAG (t, ply, TRACEREPEAT);
+      return (0);
+    }
 
 /*----------> test if captures are possible */
   capture = testcapture (b, color);
 
 /*----------> recursion termination if no captures and depth=0*/
-  if (depth == 0)
+  if (depth == 0 || ply >= MAXPLY - 1)
     {
-      if (capture == 0)
-	return (evaluation (b, color));
+      t->stats.qnodes++;
+      if (capture == 0 || ply >= MAXPLY - 1)
+	{
+	  t->stats.evaluations++;
+	  TRACEFLAG (t, ply, TRACELEAF);
+	  return (evaluation (b, color, t->e->opt.weights));
+	}
       else
-	depth = 1;
+	searchdepth = 1;
+    }
+
+/*----------> a deep enough hashtable entry makes the search unnecessary */
+  t->stats.hashprobes++;
+  switch (hashprobe (t->e, key, depth, alpha, beta, &value, &hashmove))
+    {
+    case 2:
+      t->stats.hashcuts++;
+      t->stats.hashhits++;
+      TRACEFLAG (t, ply, TRACEHIT | TRACEHASHCUT);
+      return (value);
+    case 1:
+      t->stats.hashhits++;
+      TRACEFLAG (t, ply, TRACEHIT);
+    }
+
+/*----------> probcut: the deep result is predicted from a shallow zero
+  ----------> window search. if the prediction is outside the window by
+  ----------> pcthreshold standard deviations, the node is cut. */
+  if (o->probcut && !capture && depth >= PCMINDEPTH)
+    {
+      bound = (int) ceil ((beta + o->pcthreshold * o->pcsigma - o->pcoffset) / o->pcslope);
+      if (bound < 5000 && alphabeta (t, b, depth - PCREDUCE, ply, bound - 1, bound, color) >= bound)
+	{
+	  TRACEFLAG (t, ply, TRACEPROBCUT);
+	  return (beta);
+	}
+      bound = (int) floor ((alpha - o->pcthreshold * o->pcsigma - o->pcoffset) / o->pcslope);
+      if (bound > -5000 && alphabeta (t, b, depth - PCREDUCE, ply, bound, bound + 1, color) <= bound)
+	{
+	  TRACEFLAG (t, ply, TRACEPROBCUT);
+	  return (alpha);
+	}
+      if (t->e->stop)
+	return (0);
     }
 
 /*----------> generate all possible moves in the position */
   if (capture == 0)
     {
+      t->stats.movelists++;
       numberofmoves = generatemovelist (b, movelist, color);
 /*----------> if there are no possible moves, we lose: */
       if (numberofmoves == 0)
@@ -766,35 +5984,327 @@ alphabeta (int b[46], int depth, int alpha, int beta, int color)
 	}
     }
   else
-    numberofmoves = generatecapturelist (b, movelist, color);
+    {
+      t->stats.capturelists++;
+      numberofmoves = generatecapturelist (b, movelist, color);
+    }
+
+  ordermoves (t, movelist, numberofmoves, hashmove, ply);
+
+/*----------> futility: near the horizon, when even a margin on top of the
+  ----------> material cannot reach the window, quiet moves are not searched.
+  ----------> never with a capture on the board, see below. */
+  if (o->futility && !capture && depth >= 1 && depth <= 2)
+    {
+      futile = material (b) + (color == BLACK ? futilitymargin[depth] : -futilitymargin[depth]);
+      prune = (color == BLACK) ? futile <= alpha : futile >= beta;
+    }
 
 /*----------> for all moves: execute the move, search tree, undo move. */
   for (i = 0; i < numberofmoves; i++)
     {
       domove (b, movelist[i]);
+      pushkey (t, ply, movelist[i]);
+
+/*----------> a move which leaves the opponent a capture is never pruned or
+  ----------> reduced, the material is about to change */
+      reduction = 0;
+      if ((prune || (o->lmr && !capture && depth >= 3 && i >= LMRMOVES))
+	  && !testcapture (b, color ^ CHANGECOLOR))
+	{
+	  if (prune)
+	    {
+	      undomove (b, movelist[i]);
+	      if ((color == BLACK && futile > bestvalue) || (color == WHITE && futile < bestvalue))
+		bestvalue = futile;
+	      continue;
+	    }
+	  reduction = (depth >= 6 && i >= 2 * LMRMOVES) ? 2 : 1;
+	}
 
-      value = alphabeta (b, depth - 1, alpha, beta, color ^ CHANGECOLOR);
+/*----------> late move reductions: a quiet move ordered late is searched
+  ----------> shallower with a zero window first, and again to full depth
+  ----------> only if it beats the best move so far */
+      value = 0;
+      if (reduction && color == BLACK)
+	value = alphabeta (t, b, searchdepth - 1 - reduction, ply + 1, alpha, alpha + 1, WHITE);
+      if (reduction && color == WHITE)
+	value = alphabeta (t, b, searchdepth - 1 - reduction, ply + 1, beta - 1, beta, BLACK);
+      if (!reduction || (color == BLACK && value > alpha) || (color == WHITE && value < beta))
+	value = alphabeta (t, b, searchdepth - 1, ply + 1, alpha, beta, color ^ CHANGECOLOR);
 
       undomove (b, movelist[i]);
+      if (t->e->stop)
+	return (0);
 
       if (color == BLACK)
 	{
 	  if (value >= beta)
-	    return (value);
+	    {
+	      goodmove (t, movelist[i], depth, ply, capture);
+	      t->stats.cutoffs[i < CUTINDEX ? i : CUTINDEX - 1]++;
+	      TRACEBEST (t, ply, i);
+	      TRACEFLAG (t, ply, TRACECUT);
+	      hashstore (t->e, key, depth, value, LOWER, movecode (movelist[i]));
+	      return (value);
+	    }
+	  if (value > bestvalue)
+	    bestvalue = value;
 	  if (value > alpha)
-	    alpha = value;
+	    {
+	      alpha = value;
+	      bestmove = movecode (movelist[i]);
+	      TRACEBEST (t, ply, i);
+	    }
 	}
       if (color == WHITE)
 	{
 	  if (value <= alpha)
-	    return (value);
+	    {
+	      goodmove (t, movelist[i], depth, ply, capture);
+	      t->stats.cutoffs[i < CUTINDEX ? i : CUTINDEX - 1]++;
+	      TRACEBEST (t, ply, i);
+	      TRACEFLAG (t, ply, TRACECUT);
+	      hashstore (t->e, key, depth, value, UPPER, movecode (movelist[i]));
+	      return (value);
+	    }
+	  if (value < bestvalue)
+	    bestvalue = value;
 	  if (value < beta)
-	    beta = value;
+	    {
+	      beta = value;
+	      bestmove = movecode (movelist[i]);
+	      TRACEBEST (t, ply, i);
+	    }
 	}
     }
+/*----------> no move improved on the window: the result is only a bound.
+  ----------> fail soft, mtdf needs the bound as tight as it can get */
   if (color == BLACK)
-    return (alpha);
-  return (beta);
+    hashstore (t->e, key, depth, bestvalue, bestmove ? EXACT : UPPER, bestmove);
+  else
+    hashstore (t->e, key, depth, bestvalue, bestmove ? EXACT : LOWER, bestmove);
+  return (bestvalue);
+}
+
+#ifdef TRACE
+int
+alphabeta (struct searchthread *t, int b[46], int depth, int ply, int alpha, int beta, int color)
+/*----------> purpose: searchnode, traced: the event of the node is
+  ---------->          recorded when its search returns. what a search of
+  ---------->          the same ply found before, e.g. the one probcut
+  ---------->          interrupts, is kept across. */
+{
+  long nodes = t->stats.nodes;
+  int flags = t->traceflags[ply], best = t->tracebest[ply];
+  int value;
+
+  if (t->trace == NULL)
+    return (searchnode (t, b, depth, ply, alpha, beta, color));
+  t->traceflags[ply] = 0;
+  t->tracebest[ply] = TRACENONE;
+  value = searchnode (t, b, depth, ply, alpha, beta, color);
+  tracenode (t, ply, depth, alpha, beta, value, t->stats.nodes - nodes);
+  t->traceflags[ply] = flags;
+  t->tracebest[ply] = best;
+  return (value);
+}
+
+int
+firstalphabeta (struct searchthread *t, int b[46], int depth, int alpha, int beta, int color, struct move2 *best)
+/*----------> purpose: searchroot, traced as alphabeta. */
+{
+  long nodes = t->stats.nodes;
+  int value;
+
+  if (t->trace == NULL)
+    return (searchroot (t, b, depth, alpha, beta, color, best));
+  t->traceflags[0] = 0;
+  t->tracebest[0] = TRACENONE;
+  value = searchroot (t, b, depth, alpha, beta, color, best);
+  tracenode (t, 0, depth, alpha, beta, value, t->stats.nodes - nodes);
+  return (value);
+}
+
+void
+tracenode (struct searchthread *t, int ply, int depth, int alpha, int beta, int value, long nodes)
+/*----------> purpose: add the event of the node at ply, searched with the
+  ---------->          window alpha, beta to value in nodes, to the trace
+  ---------->          buffer of t, writing the buffer out when it is full. */
+{
+  struct traceevent *ev;
+
+  if (t->trace && t->traced == TRACEEVENTS)
+    traceflush (t);
+  if (t->trace == NULL)
+    return;
+  ev = &t->trace[1 + t->traced++];
+  ev->nodes = (nodes > UINT32_MAX) ? UINT32_MAX : nodes;
+  ev->alpha = alpha;
+  ev->beta = beta;
+  ev->value = value;
+  ev->move = t->tracemove[ply] & 0xfff;
+  ev->ply = ply;
+  ev->depth = depth;
+  ev->best = t->tracebest[ply];
+  ev->flags = t->traceflags[ply];
+  if (t->tracemove[ply] >> 12)
+    ev->flags |= TRACEJUMP;
+  if (t->e->stop)
+    ev->flags |= TRACESTOP;
+}
+
+void
+traceflush (struct searchthread *t)
+/*----------> purpose: write the trace buffer of t to the trace file as one
+  ---------->          block, a traceblock and the events. the file is
+  ---------->          opened for appending and each block written at
+  ---------->          once, so that blocks of threads and processes do
+  ---------->          not mix. if it fails, t is no longer traced. */
+{
+  struct traceblock *block = (struct traceblock *) t->trace;
+  size_t size = (t->traced + 1) * sizeof (struct traceevent);
+
+  if (t->traced == 0)
+    return;
+  memcpy (block->magic, "simt", 4);
+  block->process = getpid ();
+  block->search = t->search;
+  block->thread = t->id;
+  block->events = t->traced;
+  t->traced = 0;
+  if (write (t->tracefd, t->trace, size) != (ssize_t) size)
+    {
+      free (t->trace);
+      t->trace = NULL;
+    }
+}
+#endif
+
+void
+ordermoves (struct searchthread *t, struct move2 movelist[MAXMOVES], int n, int hashmove, int ply)
+/*----------> purpose: sort the movelist: the hashtable move first, then the
+  ---------->          killer moves of this ply, then by history score.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int i, j, code, s;
+  int score[MAXMOVES];
+  struct move2 tmp;
+
+  for (i = 0; i < n; i++)
+    {
+      code = movecode (movelist[i]);
+      if (code == hashmove)
+	score[i] = 1 << 30;
+      else if (code == t->killer[ply][0])
+	score[i] = 1 << 29;
+      else if (code == t->killer[ply][1])
+	score[i] = 1 << 28;
+      else
+	score[i] = t->history[code >> 6][code & 63];
+    }
+  /* insertion sort, keeps the generation order among equals */
+  for (i = 1; i < n; i++)
+    {
+      s = score[i];
+      tmp = movelist[i];
+      for (j = i; j > 0 && score[j - 1] < s; j--)
+	{
+	  score[j] = score[j - 1];
+	  movelist[j] = movelist[j - 1];
+	}
+      score[j] = s;
+      movelist[j] = tmp;
+    }
+}
+
+void
+goodmove (struct searchthread *t, struct move2 move, int depth, int ply, int capture)
+/*----------> purpose: remember a quiet move which caused a cutoff in the
+  ---------->          killer and history tables of thread t.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  int i, j;
+  int code = movecode (move);
+
+  if (capture)
+    return;
+  if (t->killer[ply][0] != code)
+    {
+      t->killer[ply][1] = t->killer[ply][0];
+      t->killer[ply][0] = code;
+    }
+  t->history[code >> 6][code & 63] += depth * depth;
+  if (t->history[code >> 6][code & 63] > (1 << 20))
+    for (i = 0; i < 46; i++)
+      for (j = 0; j < 46; j++)
+	t->history[i][j] /= 2;
+}
+
+int
+repetition (struct searchthread *t, int ply)
+/*----------> purpose: is the position at ply a repetition of one in the game
+  ---------->          or earlier on the path? with the same side to move it
+  ---------->          can only be 4, 6, ... plies back, and never behind a
+  ---------->          man move or capture. */
+{
+  int i;
+
+  for (i = 4; i <= t->reversible[ply]; i += 2)
+    if (t->key[ply - i] == t->key[ply])
+      return (1);
+  return (0);
+}
+
+void
+pushkey (struct searchthread *t, int ply, struct move2 move)
+/*----------> purpose: the hash key and reversible count after move at ply */
+{
+  t->key[ply + 1] = hashupdate (t->key[ply], move);
+#ifdef TRACE
+  t->tracemove[ply + 1] = movecode (move) | (move.n > 2) << 12;
+#endif
+  if (move.n == 2 && ((move.m[0] >> 8) & KING))
+    t->reversible[ply + 1] = t->reversible[ply] + 1;
+  else
+    t->reversible[ply + 1] = 0;
+}
+
+void
+pollstop (struct searchthread *t)
+/*----------> purpose: called by the main thread every POLLNODES nodes; stops
+  ---------->          the search at the deadline, the node limit or when the
+  ---------->          caller of getmove says play now. */
+{
+  struct engine *e = t->e;
+
+  if (e->pondering)
+    {
+      if (e->playnow && *e->playnow)
+	e->stop = 1;
+      return;
+    }
+  /* the limits start to count when pondering ends */
+  if (!e->deadline && e->allotted)
+    e->deadline = e->ponderhit + e->allotted;
+  if ((e->deadline && walltime () >= e->deadline)
+      || (e->nodelimit && t->stats.nodes >= e->nodelimit)
+      || (e->playnow && *e->playnow))
+    e->stop = 1;
+}
+
+double
+walltime (void)
+/*----------> purpose: monotonic wall clock in seconds. clock() measures the
+  ---------->          cpu time of all threads together and is useless for
+  ---------->          time control once the search runs in parallel. */
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec + ts.tv_nsec * 1e-9);
 }
 
 void
@@ -823,7 +6333,8 @@ undomove (int b[46], struct move2 move)
   int square, before;
   int i;
 
-  for (i = 0; i < move.n; i++)
+  /* backwards, a king capturing in a circle appears twice in the move */
+  for (i = move.n - 1; i >= 0; i--)
     {
       square = (move.m[i] % 256);
       before = ((move.m[i] >> 8) % 256);
@@ -832,10 +6343,12 @@ undomove (int b[46], struct move2 move)
 }
 
 int
-evaluation (int b[46], int color)
-/*----------> purpose:
-  ----------> version: 1.1
-  ----------> date: 18th april 98 */
+evaluation (int b[46], int color, const int w[NWEIGHTS])
+/*----------> purpose: the static value of b for black, with color to move.
+  ---------->          the material part is fixed, the rest is weighted
+  ---------->          by w, see defaultweights.
+  ----------> version: 1.2
+  ----------> date: 18th october 2026 */
 {
   int i, j;
   int eval;
@@ -860,34 +6373,31 @@ evaluation (int b[46], int color)
   int tempo = 0;
   int nm, nk;
 
-  int turn = 2;			// color to move gets +turn
+  int turn = w[EVTURN];		// color to move gets +turn
 
-  int brv = 3;			// multiplier for back rank
+  int brv = w[EVBRV];		// multiplier for back rank
 
-  int kcv = 5;			// multiplier for kings in center
+  int kcv = w[EVKCV];		// multiplier for kings in center
 
-  int mcv = 1;			// multiplier for men in center
+  int mcv = w[EVMCV];		// multiplier for men in center
 
-  int mev = 1;			// multiplier for men on edge
+  int mev = w[EVMEV];		// multiplier for men on edge
 
-  int kev = 5;			// multiplier for kings on edge
+  int kev = w[EVKEV];		// multiplier for kings on edge
 
-  int cramp = 5;		// multiplier for cramp
+  int cramp = w[EVCRAMP];	// multiplier for cramp
 
-  int opening = -2;		// multipliers for tempo
+  int opening = w[EVOPENING];	// multipliers for tempo
 
-  int midgame = -1;
-  int endgame = 2;
-  int intactdoublecorner = 3;
+  int midgame = w[EVMIDGAME];
+  int endgame = w[EVENDGAME];
+  int intactdoublecorner = w[EVDOUBLECORNER];
 
 
   int backrank;
 
   int stonesinsystem = 0;
 
-#ifdef STATISTICS
-  evaluations++;
-#endif
 
 
   for (i = 5; i <= 40; i++)
@@ -934,120 +6444,20 @@ evaluation (int b[46], int color)
     code += 4;
   if (b[8] & MAN)
     code += 8;
-  switch (code)
-    {
-    case 0:
-      code = 0;
-      break;
-    case 1:
-      code = -1;
-      break;
-    case 2:
-      code = 1;
-      break;
-    case 3:
-      code = 0;
-      break;
-    case 4:
-      code = 1;
-      break;
-    case 5:
-      code = 1;
-      break;
-    case 6:
-      code = 2;
-      break;
-    case 7:
-      code = 1;
-      break;
-    case 8:
-      code = 1;
-      break;
-    case 9:
-      code = 0;
-      break;
-    case 10:
-      code = 7;
-      break;
-    case 11:
-      code = 4;
-      break;
-    case 12:
-      code = 2;
-      break;
-    case 13:
-      code = 2;
-      break;
-    case 14:
-      code = 9;
-      break;
-    case 15:
-      code = 8;
-      break;
-    }
+  code = w[EVBACKRANK + code];
   backrank = code;
 
-
-  code = 0;
-  if (b[37] & MAN)
-    code += 8;
-  if (b[38] & MAN)
-    code += 4;
-  if (b[39] & MAN)
-    code += 2;
-  if (b[40] & MAN)
-    code++;
-  switch (code)
-    {
-    case 0:
-      code = 0;
-      break;
-    case 1:
-      code = -1;
-      break;
-    case 2:
-      code = 1;
-      break;
-    case 3:
-      code = 0;
-      break;
-    case 4:
-      code = 1;
-      break;
-    case 5:
-      code = 1;
-      break;
-    case 6:
-      code = 2;
-      break;
-    case 7:
-      code = 1;
-      break;
-    case 8:
-      code = 1;
-      break;
-    case 9:
-      code = 0;
-      break;
-    case 10:
-      code = 7;
-      break;
-    case 11:
-      code = 4;
-      break;
-    case 12:
-      code = 2;
-      break;
-    case 13:
-      code = 2;
-      break;
-    case 14:
-      code = 9;
-      break;
-    case 15:
-      code = 8;
-      break;
-    }
+
+  code = 0;
+  if (b[37] & MAN)
+    code += 8;
+  if (b[38] & MAN)
+    code += 4;
+  if (b[39] & MAN)
+    code += 2;
+  if (b[40] & MAN)
+    code++;
+  code = w[EVBACKRANK + code];
   backrank -= code;
   eval += brv * backrank;
 
@@ -1129,12 +6539,12 @@ evaluation (int b[46], int color)
       if (nbk + nbm > nwk + nwm && nwk < 3)
 	{
 	  if (b[safeedge[i]] == (WHITE | KING))
-	    eval -= 15;
+	    eval -= w[EVSAFEEDGE];
 	}
       if (nwk + nwm > nbk + nbm && nbk < 3)
 	{
 	  if (b[safeedge[i]] == (BLACK | KING))
-	    eval += 15;
+	    eval += w[EVSAFEEDGE];
 	}
     }
 
@@ -1218,6 +6628,525 @@ evaluation (int b[46], int color)
 }
 
 
+int
+material (int b[46])
+/*----------> purpose: the material term of evaluation alone, for pruning
+  ---------->          decisions that need a fast estimate. */
+{
+  int i, v1 = 0, v2 = 0;
+
+  for (i = 5; i <= 40; i++)
+    {
+      if (b[i] == (BLACK | MAN))
+	v1 += 100;
+      else if (b[i] == (BLACK | KING))
+	v1 += 130;
+      else if (b[i] == (WHITE | MAN))
+	v2 += 100;
+      else if (b[i] == (WHITE | KING))
+	v2 += 130;
+    }
+  if (v1 + v2 == 0)
+    return (0);
+  return (v1 - v2 + (250 * (v1 - v2)) / (v1 + v2));
+}
+
+/*-------------- PART IIa: HASHING -----------------------------------------*/
+
+void
+initzobrist (void)
+/*----------> purpose: set up the zobrist keys, once per process
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  int i, j;
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+
+  /* xorshift64 with a fixed seed, so that keys are the same on every run */
+  for (i = 0; i < 46; i++)
+    for (j = 0; j < 17; j++)
+      {
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	zobrist[i][j] = (j == FREE || j == OCCUPIED) ? 0 : x;
+      }
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  zobristcolor = x;
+}
+
+void
+clearhashtable (struct engine *e)
+/*----------> purpose: forget all search results of engine e. a shared
+  ---------->          hashtable is kept, other processes use it. */
+{
+  if (!e->hashshared)
+    memset (e->hashtable, 0, (e->hashmask + 1) * sizeof (struct hashentry));
+  e->hashage = 0;
+}
+
+struct hashentry *
+sharedhashtable (char *name, int hashbits, uint64_t *mask)
+/*----------> purpose: map the hashtable in the posix shared memory name,
+  ---------->          creating it with 2^hashbits entries if it does not
+  ---------->          exist. an existing one keeps its size, *mask is set
+  ---------->          to fit. the entries are written without locks as in
+  ---------->          hashstore, so any number of processes may search
+  ---------->          with it at once. it lives until it is unlinked, e.g.
+  ---------->          by removing /dev/shm/name.
+  ---------->          only the process which creates it sizes it; others
+  ---------->          wait for that, so that no process maps a table
+  ---------->          larger than the object and faults on it.
+  ----------> returns NULL if it cannot be mapped.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  struct stat st;
+  struct hashentry *h;
+  size_t size = ((size_t) 1 << hashbits) * sizeof (struct hashentry);
+  int fd, tries;
+
+  if ((fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0666)) >= 0)
+    {
+      if (ftruncate (fd, size) < 0)
+	{
+	  perror (name);
+	  close (fd);
+	  shm_unlink (name);
+	  return (NULL);
+	}
+      st.st_size = 0;
+    }
+  else
+    {
+      /* another process created it and sizes it */
+      if (errno != EEXIST || (fd = shm_open (name, O_RDWR, 0666)) < 0)
+	{
+	  perror (name);
+	  return (NULL);
+	}
+      for (tries = 0; tries < 1000; tries++)
+	{
+	  if (fstat (fd, &st) < 0)
+	    {
+	      perror (name);
+	      close (fd);
+	      return (NULL);
+	    }
+	  if (st.st_size != 0)
+	    break;
+	  usleep (1000);
+	}
+      if (st.st_size == 0)
+	{
+	  fprintf (stderr, "simplech: %s was created but never sized\n", name);
+	  close (fd);
+	  return (NULL);
+	}
+    }
+  if (st.st_size != 0)
+    for (size = sizeof (struct hashentry); size < (size_t) st.st_size; size *= 2)
+      ;
+  if (st.st_size != 0 && size != (size_t) st.st_size)
+    {
+      fprintf (stderr, "simplech: %s is not a hashtable\n", name);
+      close (fd);
+      return (NULL);
+    }
+  h = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (h == MAP_FAILED)
+    {
+      perror (name);
+      return (NULL);
+    }
+  *mask = size / sizeof (struct hashentry) - 1;
+  return (h);
+}
+
+uint64_t
+hashposition (int b[46], int color)
+/*----------> purpose: compute the hash key of board b with color to move */
+{
+  int i;
+  uint64_t key = 0;
+
+  for (i = 5; i <= 40; i++)
+    key ^= zobrist[i][b[i]];
+  if (color == WHITE)
+    key ^= zobristcolor;
+  return (key);
+}
+
+uint64_t
+hashupdate (uint64_t key, struct move2 move)
+/*----------> purpose: hash key of the position after move, computed like
+  ---------->          domove does from the before and after squares */
+{
+  int i, square;
+
+  for (i = 0; i < move.n; i++)
+    {
+      square = move.m[i] % 256;
+      key ^= zobrist[square][(move.m[i] >> 8) % 256];
+      key ^= zobrist[square][(move.m[i] >> 16) % 256];
+    }
+  return (key ^ zobristcolor);
+}
+
+int
+movecode (struct move2 move)
+/*----------> purpose: from and to square of move packed into 12 bits, the
+  ---------->          form in which the hashtable and killers store moves */
+{
+  return ((move.m[0] % 256) * 64 + move.m[1] % 256);
+}
+
+int
+hashprobe (struct engine *e, uint64_t key, int depth, int alpha, int beta, int *value, int *move)
+/*----------> purpose: look up key in the hashtable. *move is set to the
+  ---------->          stored best move, or 0. returns 2 and the value in
+  ---------->          *value if the entry is deep enough to cut off, 1 if
+  ---------->          there is an entry which is not, 0 if there is none.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  struct hashentry *h = &e->hashtable[key & e->hashmask];
+  uint64_t lock, data;
+  int v, d, bound;
+
+  /* other threads write the entry concurrently, read each word once and
+     check it against the lock; a torn entry simply does not match */
+  lock = __atomic_load_n (&h->lock, __ATOMIC_RELAXED);
+  data = __atomic_load_n (&h->data, __ATOMIC_RELAXED);
+  *move = 0;
+  if ((lock ^ data) != key)
+    return (0);
+
+  v = (int) (data & 0xffff) - 32768;
+  d = (data >> 16) & 255;
+  bound = (data >> 24) & 3;
+  *move = (data >> 26) & 4095;
+  if (d < depth)
+    return (1);
+  if (bound == EXACT || (bound == LOWER && v >= beta) || (bound == UPPER && v <= alpha))
+    {
+      *value = v;
+      return (2);
+    }
+  return (1);
+}
+
+void
+hashstore (struct engine *e, uint64_t key, int depth, int value, int bound, int move)
+/*----------> purpose: store a search result in the hashtable. entries are
+  ---------->          written without locks as lock = key ^ data, so that
+  ---------->          a reader can tell a half-written entry apart.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct hashentry *h = &e->hashtable[key & e->hashmask];
+  uint64_t lock, data;
+
+  lock = __atomic_load_n (&h->lock, __ATOMIC_RELAXED);
+  data = __atomic_load_n (&h->data, __ATOMIC_RELAXED);
+  /* keep deeper results of this search for other positions */
+  if ((lock ^ data) != key && ((data >> 38) & 255) == (e->hashage & 255)
+      && (int) ((data >> 16) & 255) > depth)
+    return;
+  if (move == 0 && (lock ^ data) == key)
+    move = (data >> 26) & 4095;
+
+  data = (uint64_t) (value + 32768)
+    | ((uint64_t) depth << 16)
+    | ((uint64_t) bound << 24)
+    | ((uint64_t) move << 26)
+    | ((uint64_t) (e->hashage & 255) << 38);
+  __atomic_store_n (&h->lock, key ^ data, __ATOMIC_RELAXED);
+  __atomic_store_n (&h->data, data, __ATOMIC_RELAXED);
+}
+
+
+int
+savehashtable (struct engine *e, char *filename)
+/*----------> purpose: write the hashtable of e to filename: a header with
+  ---------->          the version, size and age of the table and a check
+  ---------->          of the zobrist keys, then the entries as they are in
+  ---------->          memory, HASHCHUNK at a time. the file is written
+  ---------->          under another name and renamed, so that a process
+  ---------->          killed meanwhile leaves the old one intact.
+  ----------> returns 0, 1 if the file cannot be written or memory runs
+  ---------->          out.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct hashheader header;
+  char *tmp;
+  FILE *fp;
+  uint64_t i, n, size = e->hashmask + 1;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, "simphash", 8);
+  header.version = HASHVERSION;
+  for (header.hashbits = 0; ((uint64_t) 1 << header.hashbits) < size; header.hashbits++)
+    ;
+  header.hashage = e->hashage;
+  header.entrysize = sizeof (struct hashentry);
+  header.zobrist = zobrist[5][BLACK | MAN] ^ zobrist[40][WHITE | KING] ^ zobristcolor;
+
+  if ((tmp = malloc (strlen (filename) + 5)) == NULL)
+    {
+      fprintf (stderr, "simplech: out of memory\n");
+      return (1);
+    }
+  sprintf (tmp, "%s.tmp", filename);
+  if ((fp = fopen (tmp, "wb")) == NULL)
+    {
+      perror (tmp);
+      free (tmp);
+      return (1);
+    }
+  n = fwrite (&header, sizeof (header), 1, fp);
+  for (i = 0; n == 1 && i < size; i += HASHCHUNK)
+    n = (fwrite (e->hashtable + i, sizeof (struct hashentry) * (size - i < HASHCHUNK ? size - i : HASHCHUNK),
+		 1, fp));
+  if (fclose (fp) || n != 1 || rename (tmp, filename))
+    {
+      perror (filename);
+      unlink (tmp);
+      free (tmp);
+      return (1);
+    }
+  free (tmp);
+  return (0);
+}
+
+int
+loadhashtable (struct engine *e, char *filename)
+/*----------> purpose: read a hashtable saved by savehashtable into e. a
+  ---------->          table of the same size is read straight into place;
+  ---------->          else each entry is moved to its slot in the table of
+  ---------->          e, where the deeper of two colliding entries stays.
+  ----------> returns 0, 1 if the file cannot be read or is no hashtable of
+  ---------->          this version or memory runs out; the table is
+  ---------->          cleared if it breaks off. */
+{
+  struct hashheader header;
+  struct hashentry *chunk, *h;
+  FILE *fp;
+  uint64_t i, j, n, key, size;
+
+  if ((fp = fopen (filename, "rb")) == NULL)
+    {
+      perror (filename);
+      return (1);
+    }
+  if (fread (&header, sizeof (header), 1, fp) != 1 || memcmp (header.magic, "simphash", 8)
+      || header.version != HASHVERSION || header.entrysize != sizeof (struct hashentry)
+      || header.hashbits > 40
+      || header.zobrist != (zobrist[5][BLACK | MAN] ^ zobrist[40][WHITE | KING] ^ zobristcolor))
+    {
+      fprintf (stderr, "simplech: %s is not a hashtable of version %i\n", filename, HASHVERSION);
+      fclose (fp);
+      return (1);
+    }
+  size = (uint64_t) 1 << header.hashbits;
+  e->hashage = header.hashage;
+  if (size == e->hashmask + 1)
+    {
+      for (i = 0; i < size; i += n)
+	if ((n = fread (e->hashtable + i, sizeof (struct hashentry),
+			size - i < HASHCHUNK ? size - i : HASHCHUNK, fp)) == 0)
+	  break;
+    }
+  else
+    {
+      if ((chunk = malloc (HASHCHUNK * sizeof (struct hashentry))) == NULL)
+	{
+	  fprintf (stderr, "simplech: out of memory\n");
+	  fclose (fp);
+	  return (1);
+	}
+      clearhashtable (e);
+      e->hashage = header.hashage;
+      for (i = 0; i < size; i += n)
+	{
+	  if ((n = fread (chunk, sizeof (struct hashentry),
+			  size - i < HASHCHUNK ? size - i : HASHCHUNK, fp)) == 0)
+	    break;
+	  for (j = 0; j < n; j++)
+	    {
+	      if (chunk[j].lock == 0 && chunk[j].data == 0)
+		continue;
+	      key = chunk[j].lock ^ chunk[j].data;
+	      h = &e->hashtable[key & e->hashmask];
+	      if ((h->lock || h->data) && ((h->data >> 16) & 255) >= ((chunk[j].data >> 16) & 255))
+		continue;
+	      *h = chunk[j];
+	    }
+	}
+      free (chunk);
+    }
+  fclose (fp);
+  if (i < size)
+    {
+      fprintf (stderr, "simplech: %s is cut short\n", filename);
+      clearhashtable (e);
+      return (1);
+    }
+  return (0);
+}
+
+struct store *
+openstore (char *filename, int slotbits)
+/*----------> purpose: map the analysis store in filename, creating it with
+  ---------->          2^slotbits slots if it does not exist. the mapping is
+  ---------->          shared, so all engines and processes which open the
+  ---------->          same file see each other's results at once.
+  ----------> returns NULL if the file cannot be opened or is no store.
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+{
+  struct store *s;
+  struct storeheader header;
+  struct stat st;
+  void *map;
+  size_t size;
+  int fd;
+
+  if ((fd = open (filename, O_RDWR | O_CREAT, 0666)) < 0 || fstat (fd, &st) < 0)
+    {
+      perror (filename);
+      if (fd >= 0)
+	close (fd);
+      return (NULL);
+    }
+  memset (&header, 0, sizeof (header));
+  if (st.st_size == 0)
+    {
+      memcpy (header.magic, "simpstor", 8);
+      header.version = STOREVERSION;
+      header.slotbits = slotbits;
+      size = sizeof (header) + ((size_t) 1 << slotbits) * sizeof (struct storeentry);
+      if (ftruncate (fd, size) < 0 || pwrite (fd, &header, sizeof (header), 0) != sizeof (header))
+	{
+	  perror (filename);
+	  close (fd);
+	  return (NULL);
+	}
+    }
+  else if (pread (fd, &header, sizeof (header), 0) != sizeof (header)
+	   || memcmp (header.magic, "simpstor", 8) || header.version != STOREVERSION
+	   || header.slotbits > 40
+	   || (size_t) st.st_size != sizeof (header) + ((size_t) 1 << header.slotbits) * sizeof (struct storeentry))
+    {
+      fprintf (stderr, "simplech: %s is not an analysis store of version %i\n", filename, STOREVERSION);
+      close (fd);
+      return (NULL);
+    }
+  size = sizeof (header) + ((size_t) 1 << header.slotbits) * sizeof (struct storeentry);
+  map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED || (s = malloc (sizeof (struct store))) == NULL)
+    {
+      perror (filename);
+      if (map != MAP_FAILED)
+	munmap (map, size);
+      return (NULL);
+    }
+  s->header = map;
+  s->entry = (struct storeentry *) (s->header + 1);
+  s->mask = ((uint64_t) 1 << header.slotbits) - 1;
+  s->size = size;
+  return (s);
+}
+
+void
+closestore (struct store *s)
+/*----------> purpose: unmap an analysis store. the results are in the file
+  ---------->          already, the system writes them back. */
+{
+  munmap (s->header, s->size);
+  free (s);
+}
+
+int
+storeprobe (struct store *s, uint64_t key, int *depth, int *value, int *move, long *nodes)
+/*----------> purpose: look up key in the analysis store, without a lock: an
+  ---------->          entry is read word by word and checked against its
+  ---------->          lock, one being written does not match.
+  ----------> returns 1 and the stored result, 0 if there is none. */
+{
+  struct storeentry *h;
+  uint64_t lock, data, n;
+  int j;
+
+  for (j = 0; j < STOREPROBE; j++)
+    {
+      h = &s->entry[(key + j) & s->mask];
+      lock = __atomic_load_n (&h->lock, __ATOMIC_ACQUIRE);
+      data = __atomic_load_n (&h->data, __ATOMIC_RELAXED);
+      n = __atomic_load_n (&h->nodes, __ATOMIC_RELAXED);
+      if ((lock ^ data ^ n) == key)
+	{
+	  *value = (int) (data & 0xffff) - 32768;
+	  *depth = (data >> 16) & 255;
+	  *move = (data >> 26) & 4095;
+	  *nodes = n;
+	  return (1);
+	}
+      if (lock == 0 && data == 0 && n == 0)
+	return (0);
+    }
+  return (0);
+}
+
+int
+storeupdate (struct store *s, uint64_t key, int depth, int value, int move, long nodes)
+/*----------> purpose: put a search result into the analysis store, in
+  ---------->          the slot of key or the first free one of the
+  ---------->          STOREPROBE slots from key on. a stored result is
+  ---------->          only replaced by a deeper one, or by one of the same
+  ---------->          depth with more nodes. the lock is written last; two
+  ---------->          writers of one slot at the same time may leave it
+  ---------->          torn, which readers see as empty.
+  ----------> returns 1 if the result was stored, 0 if it was not better
+  ---------->          or there was no room. */
+{
+  struct storeentry *h, *slot = NULL;
+  uint64_t lock, data, n;
+  int j;
+
+  for (j = 0; j < STOREPROBE; j++)
+    {
+      h = &s->entry[(key + j) & s->mask];
+      lock = __atomic_load_n (&h->lock, __ATOMIC_ACQUIRE);
+      data = __atomic_load_n (&h->data, __ATOMIC_RELAXED);
+      n = __atomic_load_n (&h->nodes, __ATOMIC_RELAXED);
+      if ((lock ^ data ^ n) == key)
+	{
+	  if ((int) ((data >> 16) & 255) > depth
+	      || ((int) ((data >> 16) & 255) == depth && (long) n >= nodes))
+	    return (0);
+	  slot = h;
+	  break;
+	}
+      if (slot == NULL && lock == 0 && data == 0 && n == 0)
+	slot = h;
+    }
+  if (slot == NULL)
+    return (0);
+  data = (uint64_t) (value + 32768)
+    | ((uint64_t) depth << 16)
+    | ((uint64_t) EXACT << 24)
+    | ((uint64_t) move << 26);
+  __atomic_store_n (&slot->data, data, __ATOMIC_RELAXED);
+  __atomic_store_n (&slot->nodes, (uint64_t) nodes, __ATOMIC_RELAXED);
+  __atomic_store_n (&slot->lock, key ^ data ^ (uint64_t) nodes, __ATOMIC_RELEASE);
+  return (1);
+}
 
 /*-------------- PART III: MOVE GENERATION ----------------------------------*/
 
@@ -1230,9 +7159,6 @@ generatemovelist (int b[46], struct move2 movelist[MAXMOVES], int color)
   int n = 0, m;
   int i;
 
-#ifdef STATISTICS
-  generatemovelists++;
-#endif
 
   if (color == BLACK)
     {
@@ -1495,9 +7421,6 @@ generatecapturelist (int b[46], struct move2 movelist[MAXMOVES], int color)
   int i;
   int tmp;
 
-#ifdef STATISTICS
-  generatecapturelists++;
-#endif
 
   if (color == BLACK)
     {
@@ -2257,9 +8180,6 @@ testcapture (int b[46], int color)
 {
   int i;
 
-#ifdef STATISTICS
-  testcaptures++;
-#endif
 
   if (color == BLACK)
     {
@@ -2356,3 +8276,222 @@ testcapture (int b[46], int color)
     }
   return (0);
 }
+
+
+/*-------------- PART IV: CHECKERBOARD INTERFACE ----------------------------*/
+
+/* the squares 5..40 of b in the order of the checkerboard rows: the j-th
+   is board[2 * (j % 4) + y % 2][y] with y = j / 4 */
+static const int cbsquares[32] =
+{5, 6, 7, 8, 10, 11, 12, 13, 14, 15, 16, 17, 19, 20, 21, 22,
+ 23, 24, 25, 26, 28, 29, 30, 31, 32, 33, 34, 35, 37, 38, 39, 40};
+
+int
+getmove (int board[8][8], int color, double maxtime, char str[1024], int *playnow, int info, int moreinfo, struct CBmove *move)
+/*----------> purpose: the checkerboard engine entry point, see simplech.h.
+  ---------->          each calling thread gets its own engine on first use.
+  ---------->          with CB_EXACT_TIME in info maxtime is the limit of
+  ---------->          the search, else its average: the search gets a
+  ---------->          clock of CBMOVES such moves, from which allocatetime
+  ---------->          gives it a soft limit a little beyond maxtime and a
+  ---------->          hard one a few times beyond.
+  ----------> version: 1.1
+  ----------> date: 18th october 2026 */
+{
+  struct cbsession *s;
+  struct options opt;
+  struct limits lim = {0};
+  struct move2 best, movelist[MAXMOVES];
+  int b[46];
+  int n, eval = 0, depth = 0;
+  long nodes = 0;
+  double start = walltime ();
+
+  (void) moreinfo;		/* checkerboard's, not used */
+  pthread_once (&cbonce, cbinit);
+  if ((s = pthread_getspecific (cbkey)) == NULL)
+    {
+      defaultoptions (&opt);
+      if ((s = calloc (1, sizeof (struct cbsession))) == NULL
+	  || (s->e = newengine (&opt)) == NULL)
+	{
+	  free (s);
+	  sprintf (str, "simplech: out of memory");
+	  return (CB_UNKNOWN);
+	}
+      pthread_setspecific (cbkey, s);
+    }
+
+  cbtoboard (board, b);
+  if ((info & CB_RESET_MOVES) || !cbcontinue (s, b, color))
+    gamestart (s->e, b, color);
+
+  n = generatecapturelist (b, movelist, color);
+  if (n == 0)
+    n = generatemovelist (b, movelist, color);
+  if (n == 0)
+    {
+      sprintf (str, "no legal move");
+      return (CB_LOSS);
+    }
+  if (n == 1)
+    best = movelist[0];
+  else
+    {
+      if (info & CB_EXACT_TIME)
+	lim.time = maxtime;
+      else
+	{
+	  /* a search stops on average at two thirds of its soft limit */
+	  lim.remaining = CBMOVES * 1.5 * maxtime;
+	  lim.movestogo = CBMOVES;
+	}
+      s->e->playnow = playnow;
+      nodes = smpsearch (s->e, b, color, &lim, &best, &eval, &depth);
+      s->e->playnow = NULL;
+    }
+
+  domove (b, best);
+  gamemove (s->e, best);
+  memcpy (s->b, b, sizeof (s->b));
+  s->color = color ^ CHANGECOLOR;
+  boardtocb (b, board);
+  cbmove (best, move);
+
+  if (n == 1)
+    sprintf (str, "only move");
+  else
+    sprintf (str, "depth %i, eval %i, nodes %li, time %.2f s", depth, eval, nodes, walltime () - start);
+  if (color == WHITE)
+    eval = -eval;
+  if (eval >= 4000)
+    return (CB_WIN);
+  if (eval <= -4000)
+    return (CB_LOSS);
+  return (CB_UNKNOWN);
+}
+
+int
+enginecommand (char str[256], char reply[1024])
+/*----------> purpose: answer checkerboard's questions about the engine.
+  ----------> returns 1 if the command is known, 0 otherwise. */
+{
+  if (!strcmp (str, "name"))
+    sprintf (reply, "simple checkers 1.11");
+  else if (!strcmp (str, "about"))
+    sprintf (reply, "simple checkers\nby martin fierz");
+  else if (!strcmp (str, "get protocolversion"))
+    sprintf (reply, "2");
+  else if (!strcmp (str, "get gametype"))
+    sprintf (reply, "21");
+  else
+    {
+      sprintf (reply, "?");
+      return (0);
+    }
+  return (1);
+}
+
+void
+cbinit (void)
+{
+  pthread_key_create (&cbkey, cbfree);
+}
+
+void
+cbfree (void *arg)
+/*----------> purpose: free the session when its thread exits */
+{
+  struct cbsession *s = arg;
+
+  freeengine (s->e);
+  free (s);
+}
+
+int
+cbcontinue (struct cbsession *s, int b[46], int color)
+/*----------> purpose: if b is one move of the opponent after the board the
+  ---------->          session left with its last move, record that move in
+  ---------->          the game of its engine.
+  ----------> returns 1 if it was, 0 if b starts a new game. */
+{
+  struct move2 movelist[MAXMOVES];
+  int i, n;
+
+  if (s->e->gameplies == 0 || s->color != (color ^ CHANGECOLOR))
+    return (0);
+  n = generatecapturelist (s->b, movelist, s->color);
+  if (n == 0)
+    n = generatemovelist (s->b, movelist, s->color);
+  for (i = 0; i < n; i++)
+    {
+      domove (s->b, movelist[i]);
+      if (!memcmp (s->b, b, sizeof (s->b)))
+	{
+	  gamemove (s->e, movelist[i]);
+	  return (1);
+	}
+      undomove (s->b, movelist[i]);
+    }
+  return (0);
+}
+
+void
+cbtoboard (int board[8][8], int b[46])
+/*----------> purpose: the checkerboard board as b */
+{
+  int i, j, y;
+
+  for (i = 0; i < 46; i++)
+    b[i] = OCCUPIED;
+  for (j = 0; j < 32; j++)
+    {
+      y = j / 4;
+      i = board[2 * (j % 4) + y % 2][y];
+      b[cbsquares[j]] = i ? i : FREE;
+    }
+}
+
+void
+boardtocb (int b[46], int board[8][8])
+/*----------> purpose: b as the checkerboard board */
+{
+  int j, y;
+
+  for (j = 0; j < 32; j++)
+    {
+      y = j / 4;
+      board[2 * (j % 4) + y % 2][y] = (b[cbsquares[j]] == FREE) ? 0 : b[cbsquares[j]];
+    }
+}
+
+void
+cbmove (struct move2 move, struct CBmove *cbm)
+/*----------> purpose: move as a checkerboard move. the captured pieces are
+  ---------->          in move in the order they are taken, so each square
+  ---------->          landed on is the one behind the captured piece. */
+{
+  int j, k, square = move.m[0] % 256;
+  struct coor c[46];
+
+  for (j = 0; j < 32; j++)
+    {
+      c[cbsquares[j]].y = j / 4;
+      c[cbsquares[j]].x = 2 * (j % 4) + (j / 4) % 2;
+    }
+  memset (cbm, 0, sizeof (struct CBmove));
+  cbm->jumps = move.n - 2;
+  cbm->oldpiece = (move.m[0] >> 8) % 256;
+  cbm->newpiece = (move.m[1] >> 16) % 256;
+  cbm->from = c[move.m[0] % 256];
+  cbm->to = c[move.m[1] % 256];
+  cbm->path[0] = cbm->from;
+  for (k = 0; k < cbm->jumps && k < 11; k++)
+    {
+      cbm->del[k] = c[move.m[k + 2] % 256];
+      cbm->delpiece[k] = (move.m[k + 2] >> 8) % 256;
+      square = 2 * (move.m[k + 2] % 256) - square;
+      cbm->path[k + 1] = c[square];
+    }
+  cbm->path[cbm->jumps > 0 ? k : 1] = cbm->to;
+}
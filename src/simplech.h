@@ -0,0 +1,61 @@
+/* simplech.h: the CheckerBoard engine interface of libsimplech.so
+
+   the board is int board[8][8], board[x][y] with x the column and y the
+   row, board[0][0] the square next to black's lower left corner. a square
+   holds 0 when empty, else CB_BLACK or CB_WHITE with CB_MAN or CB_KING.
+
+   getmove searches board for color, plays the move on board and
+   describes it in move. with CB_EXACT_TIME in info it searches for at
+   most maxtime seconds, else for maxtime seconds on average, a single
+   move taking up to a few times that. a search in progress stops
+   early when *playnow becomes nonzero. str receives information on the
+   search. the return value is CB_WIN, CB_LOSS, CB_DRAW or CB_UNKNOWN, the
+   outcome the search expects.
+
+   getmove may be called from several threads at the same time. each
+   thread has its own engine and hashtable, kept from one call to the
+   next; a thread follows the game it plays, so that repetitions are
+   known, until info has CB_RESET_MOVES or a board does not continue it. */
+
+#ifndef SIMPLECH_H
+#define SIMPLECH_H
+
+#define CB_WHITE 1
+#define CB_BLACK 2
+#define CB_MAN 4
+#define CB_KING 8
+
+/* getmove return values */
+#define CB_DRAW 0
+#define CB_WIN 1
+#define CB_LOSS 2
+#define CB_UNKNOWN 3
+
+/* getmove info flags */
+#define CB_RESET_MOVES 1	/* a new game starts with this board */
+#define CB_EXACT_TIME 2		/* maxtime is a limit, not an average */
+
+#define CBAPI __attribute__ ((visibility ("default")))
+
+struct coor
+  {
+    int x;
+    int y;
+  };
+
+struct CBmove
+  {
+    int jumps;			/* number of pieces captured */
+    int newpiece;		/* the piece after the move */
+    int oldpiece;		/* and before */
+    struct coor from, to;
+    struct coor path[12];	/* from, the squares landed on, to */
+    struct coor del[12];	/* the captured pieces */
+    int delpiece[12];
+  };
+
+CBAPI int getmove (int board[8][8], int color, double maxtime, char str[1024],
+		   int *playnow, int info, int moreinfo, struct CBmove *move);
+CBAPI int enginecommand (char str[256], char reply[1024]);
+
+#endif
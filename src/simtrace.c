@@ -0,0 +1,312 @@
+/*----------> simtrace: report on a search trace of simplech
+
+  simplech, compiled with TRACE defined, writes the search to the file of
+  its trace option: for every node of alphabeta one event of 16 bytes,
+  when the search of the node returns. a thread buffers its events and
+  appends them as a block, a block header of 16 bytes and up to 65535
+  events. the blocks of one thread of one search are in order; those of
+  other threads, searches and processes may be between them.
+
+  the events of a block are in the order the nodes were left, children
+  before their parent: the parent of a node at ply p is the next node of
+  its thread at a ply below p.
+
+  usage: simtrace [-top n] [-ply p] file
+
+  reports the nodes by ply and by remaining depth, how often the first
+  move cut or was best, and the n (10) subtrees with the most nodes below
+  the root, or at ply p, with the moves that lead to them.
+
+  ----------> version: 1.0
+  ----------> date: 18th october 2026 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------> definitions, as in simplech.c */
+#define MAXPLY 128
+#define MAXDEPTH 99
+#define CUTINDEX 8		/* cutoffs are counted by move index up to this */
+#define TRACENONE 255
+#define TRACEHIT 1
+#define TRACEHASHCUT 2
+#define TRACELEAF 4
+#define TRACEREPEAT 8
+#define TRACEPROBCUT 16
+#define TRACECUT 32
+#define TRACESTOP 64
+#define TRACEJUMP 128
+#define MAXTOP 100
+
+/*----------> structure definitions */
+struct traceevent
+  {
+    uint32_t nodes;		/* in the subtree of the node, itself included */
+    int16_t alpha, beta;	/* the window the node was searched with */
+    int16_t value;		/* its result */
+    uint16_t move;		/* from * 64 + to, internal squares */
+    uint8_t ply, depth;
+    uint8_t best;		/* index of the move which cut or was best */
+    uint8_t flags;
+  };
+
+struct traceblock
+  {
+    char magic[4];		/* "simt" */
+    uint32_t process;
+    uint32_t search;
+    uint16_t thread;
+    uint16_t events;
+  };
+
+struct plystats
+  {
+    long nodes, leaves, hits, hashcuts, repetitions, probcuts;
+    long cutnodes, firstcuts;
+  };
+
+struct subtree			/* one of the most expensive */
+  {
+    struct traceevent ev;
+    uint32_t process, search;	/* its thread */
+    uint16_t thread;
+    int level;			/* ply of the last ancestor found */
+    int move[MAXPLY];		/* the moves to it, by ply */
+  };
+
+/*----------> function prototypes */
+void usage (void);
+int squarenumber (int square);
+char *movestring (int move, char str[16]);
+void addsubtree (struct subtree *top, int *n, int max, struct traceblock *h, struct traceevent *ev);
+void ancestor (struct subtree *top, int n, struct traceblock *h, struct traceevent *ev);
+
+int
+main (int argc, char *argv[])
+{
+  FILE *fp;
+  char *filename = NULL;
+  int i, k, ply = -1;
+  int maxtop = 10, tops = 0;
+  long blocks = 0, events = 0, searches = 0;
+  long cuts[CUTINDEX] = {0}, cutnodes = 0, cutsum = 0;
+  long pvnodes = 0, pvfirst = 0, allnodes = 0, stopped = 0;
+  long depthnodes[MAXDEPTH + 2] = {0}, depthsum[MAXDEPTH + 2] = {0};
+  uint32_t lastsearch = 0, lastprocess = 0;
+  struct plystats *p, plies[MAXPLY] = {{0}};
+  struct traceblock h;
+  struct traceevent *ev, *buffer;
+  struct subtree *top;
+  char str[16];
+
+  for (i = 1; i < argc; i++)
+    if (!strcmp (argv[i], "-top") && i + 1 < argc)
+      maxtop = atoi (argv[++i]);
+    else if (!strcmp (argv[i], "-ply") && i + 1 < argc)
+      ply = atoi (argv[++i]);
+    else if (argv[i][0] != '-' && filename == NULL)
+      filename = argv[i];
+    else
+      usage ();
+  if (filename == NULL)
+    usage ();
+  if (maxtop < 0)
+    maxtop = 0;
+  if (maxtop > MAXTOP)
+    maxtop = MAXTOP;
+  if ((fp = fopen (filename, "rb")) == NULL)
+    {
+      perror (filename);
+      return (1);
+    }
+  buffer = malloc (65536 * sizeof (struct traceevent));
+  top = calloc (MAXTOP + 1, sizeof (struct subtree));
+  if (buffer == NULL || top == NULL)
+    {
+      fprintf (stderr, "simtrace: out of memory\n");
+      return (1);
+    }
+
+/*----------> one pass over the blocks */
+  while (fread (&h, sizeof (h), 1, fp) == 1)
+    {
+      if (memcmp (h.magic, "simt", 4))
+	{
+	  fprintf (stderr, "simtrace: %s: bad block after %li events\n", filename, events);
+	  break;
+	}
+      if (fread (buffer, sizeof (struct traceevent), h.events, fp) != h.events)
+	{
+	  fprintf (stderr, "simtrace: %s: truncated\n", filename);
+	  break;
+	}
+      blocks++;
+      if (h.search != lastsearch || h.process != lastprocess)
+	searches++;
+      lastsearch = h.search;
+      lastprocess = h.process;
+      for (k = 0; k < h.events; k++)
+	{
+	  ev = &buffer[k];
+	  events++;
+	  p = &plies[ev->ply < MAXPLY ? ev->ply : MAXPLY - 1];
+	  p->nodes++;
+	  if (ev->flags & TRACELEAF)
+	    p->leaves++;
+	  if (ev->flags & TRACEHIT)
+	    p->hits++;
+	  if (ev->flags & TRACEHASHCUT)
+	    p->hashcuts++;
+	  if (ev->flags & TRACEREPEAT)
+	    p->repetitions++;
+	  if (ev->flags & TRACEPROBCUT)
+	    p->probcuts++;
+	  if (ev->flags & TRACESTOP)
+	    stopped++;
+	  i = (ev->depth <= MAXDEPTH) ? ev->depth : MAXDEPTH + 1;
+	  depthnodes[i]++;
+	  depthsum[i] += ev->nodes;
+/*----------> move ordering: where the cutting move was, how often the
+  ----------> best move of a node inside the window was first */
+	  if (ev->flags & TRACECUT)
+	    {
+	      p->cutnodes++;
+	      cutnodes++;
+	      cutsum += ev->best;
+	      cuts[ev->best < CUTINDEX ? ev->best : CUTINDEX - 1]++;
+	      if (ev->best == 0)
+		p->firstcuts++;
+	    }
+	  else if (ev->best != TRACENONE)
+	    {
+	      pvnodes++;
+	      if (ev->best == 0)
+		pvfirst++;
+	    }
+	  else if (!(ev->flags & (TRACELEAF | TRACEHASHCUT | TRACEREPEAT | TRACEPROBCUT | TRACESTOP)))
+	    allnodes++;
+	  ancestor (top, tops, &h, ev);
+	  if ((ply < 0 && ev->ply > 0) || ev->ply == ply)
+	    addsubtree (top, &tops, maxtop, &h, ev);
+	}
+    }
+  fclose (fp);
+
+  printf ("%li events in %li blocks, %li searches", events, blocks, searches);
+  if (stopped)
+    printf (", %li nodes left by a stopped search", stopped);
+  printf ("\n\n");
+
+  printf ("ply      nodes    leaves   tt hit  tt cut   cut nodes  first cut\n");
+  for (i = 0; i < MAXPLY; i++)
+    {
+      p = &plies[i];
+      if (p->nodes == 0)
+	continue;
+      printf ("%3i %10li %9li %7.1f%% %6.1f%% %11li %9.1f%%\n", i, p->nodes, p->leaves,
+	      100.0 * p->hits / p->nodes, 100.0 * p->hashcuts / p->nodes, p->cutnodes,
+	      p->cutnodes ? 100.0 * p->firstcuts / p->cutnodes : 0.0);
+    }
+
+  printf ("\ndepth      nodes   subtree\n");
+  for (i = MAXDEPTH + 1; i >= 0; i--)
+    if (depthnodes[i])
+      printf ("%5i %10li %9.1f\n", i, depthnodes[i], (double) depthsum[i] / depthnodes[i]);
+
+  printf ("\nmove ordering\n");
+  printf ("cut nodes %li, cut by move", cutnodes);
+  for (i = 0; i < CUTINDEX; i++)
+    printf (" %i%s %.1f%%", i + 1, (i == CUTINDEX - 1) ? "+" : "", cutnodes ? 100.0 * cuts[i] / cutnodes : 0.0);
+  printf (", mean %.2f\n", cutnodes ? 1.0 + (double) cutsum / cutnodes : 0.0);
+  printf ("pv nodes %li, best move first %.1f%%\n", pvnodes, pvnodes ? 100.0 * pvfirst / pvnodes : 0.0);
+  printf ("all nodes %li\n", allnodes);
+
+  if (tops)
+    printf ("\nmost expensive subtrees\n");
+  for (i = 0; i < tops; i++)
+    {
+      ev = &top[i].ev;
+      printf ("%10u nodes, search %u thread %u ply %i depth %i window %i %i value %i%s%s:",
+	      ev->nodes, top[i].search, top[i].thread, ev->ply, ev->depth, ev->alpha, ev->beta, ev->value,
+	      (ev->flags & TRACECUT) ? " cut" : "", (ev->flags & TRACESTOP) ? " stopped" : "");
+      for (k = 1; k <= ev->ply; k++)
+	{
+	  if (k < top[i].level)
+	    {
+	      printf (" ..");
+	      k = top[i].level - 1;
+	      continue;
+	    }
+	  printf (" %s", movestring (top[i].move[k], str));
+	}
+      printf ("\n");
+    }
+  free (buffer);
+  free (top);
+  return (0);
+}
+
+void
+usage (void)
+{
+  fprintf (stderr, "usage: simtrace [-top n] [-ply p] file\n");
+  exit (1);
+}
+
+int
+squarenumber (int square)
+/*----------> purpose: the standard number of an internal square 5..40 */
+{
+  int k = square - 5 - square / 9;
+
+  return (4 * (k / 4) + 4 - k % 4);
+}
+
+char *
+movestring (int move, char str[16])
+/*----------> purpose: write a move of the path, movecode and TRACEJUMP << 12,
+  ---------->          as e.g. 11-15 or 15x24. */
+{
+  sprintf (str, "%i%c%i", squarenumber ((move >> 6) & 63), (move & (TRACEJUMP << 12)) ? 'x' : '-',
+	   squarenumber (move & 63));
+  return (str);
+}
+
+void
+addsubtree (struct subtree *top, int *n, int max, struct traceblock *h, struct traceevent *ev)
+/*----------> purpose: keep the event ev of the thread of h if it is among
+  ---------->          the max with the most nodes so far; top is sorted. */
+{
+  int i;
+
+  if (max == 0 || (*n == max && ev->nodes <= top[max - 1].ev.nodes))
+    return;
+  i = (*n < max) ? (*n)++ : max - 1;
+  for (; i > 0 && top[i - 1].ev.nodes < ev->nodes; i--)
+    top[i] = top[i - 1];
+  top[i].ev = *ev;
+  top[i].process = h->process;
+  top[i].search = h->search;
+  top[i].thread = h->thread;
+  top[i].level = ev->ply;
+  top[i].move[ev->ply] = ev->move | ((ev->flags & TRACEJUMP) << 12);
+}
+
+void
+ancestor (struct subtree *top, int n, struct traceblock *h, struct traceevent *ev)
+/*----------> purpose: ev, of the thread of h, is the parent of the kept
+  ---------->          subtrees of the thread whose last ancestor found is
+  ---------->          deeper; record its move on their paths. */
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    if (ev->ply < top[i].level && top[i].thread == h->thread
+	&& top[i].search == h->search && top[i].process == h->process)
+      {
+	top[i].level = ev->ply;
+	top[i].move[ev->ply] = ev->move | ((ev->flags & TRACEJUMP) << 12);
+      }
+}